@@ -1,13 +1,25 @@
 #ifndef ACTION_H
 #define ACTION_H
 
+#include <stdint.h>
+
 enum Action {
   NONE,
   CW,
   CCW,
   SELECT,
-  SELECT_HOLD,
+  SELECT_HOLD,   // Fired once the button has been held for 3 s, while still down
   TIME_CHANGE,
+  ACTION_COUNT   // Number of actions, not an action
+};
+
+// One loop iteration's worth of input. Rotation carries the whole burst:
+// delta is the signed detent count (positive = CW) and velocity is in
+// detents per second, so states can move several steps at once.
+struct ActionEvent {
+  Action action;
+  int16_t delta;
+  uint16_t velocity;
 };
 
 #endif // ACTION_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef BUS_H
+#define BUS_H
+
+#include <Arduino.h>
+
+// The shared I2C bus. Every device transaction goes through here so bus use
+// can be accounted per device address and per call site. Call sites are
+// named by string literals and told apart by pointer. Loop task only.
+class Bus {
+public:
+    // Wire's endTransmission() codes run 1-5; this marks a read that came up short
+    static const uint8_t ERROR_SHORT_READ = 0xFF;
+
+    static void begin(int sda, int scl, size_t bufferSize);
+
+    // Each call is one transaction and returns 0 or an error code
+    static uint8_t probe(uint8_t address, const char* site);
+    static uint8_t write(uint8_t address, const uint8_t* data, size_t length, const char* site);
+    // Write command (a register or memory address), then read length bytes
+    // after a repeated start
+    static uint8_t read(uint8_t address, const uint8_t* command, size_t commandLength,
+                        uint8_t* data, size_t length, const char* site);
+
+    // Per-minute report of the window since the last call, which starts a new one
+    static void logStats();
+    static void dump(Print& out); // Totals since boot
+
+private:
+    static const uint8_t MAX_DEVICES = 8;
+    static const uint8_t MAX_SITES = 24;
+
+    struct Counters {
+        uint32_t transactions;
+        uint32_t bytes; // On the wire, address bytes included
+        uint32_t nacks; // Any non-zero result, NACKs being the usual one
+        uint32_t micros;
+    };
+
+    struct Device {
+        uint8_t address;
+        Counters window;
+        Counters total;
+    };
+
+    struct Site {
+        const char* name;
+        uint8_t address;
+        Counters window;
+        Counters total;
+    };
+
+    static Device devices[MAX_DEVICES];
+    static uint8_t deviceCount;
+    static Site sites[MAX_SITES];
+    static uint8_t siteCount;
+    static uint32_t untracked; // Transactions past the table sizes
+    static unsigned long windowStart;
+
+    static void account(uint8_t address, const char* site, size_t bytes, uint8_t error, uint32_t elapsed);
+    static void add(Counters& counters, size_t bytes, uint8_t error, uint32_t elapsed);
+};
+
+#endif // BUS_H
@@ -2,9 +2,22 @@
 #define CLOCK_H
 
 #include <Arduino.h>
-#include <Wire.h>
+#include <atomic>
+#include "display_text.h"
 
 class Clock {
+public:
+    // Decoded copy of the RTC time registers, refreshed by a single burst read
+    struct Snapshot {
+        uint8_t seconds;
+        uint8_t minutes;
+        uint8_t hours;      // 24-hour format
+        uint8_t dayOfWeek;  // 0=Sunday, 1=Monday, ..., 6=Saturday
+        uint8_t date;
+        uint8_t month;
+        uint16_t year;
+    };
+
 private:
     static const uint8_t RTC_ADDRESS = 0x68;
     static const uint8_t RTC_SECONDS_REG = 0x00;
@@ -15,13 +28,23 @@ private:
     static const uint8_t RTC_MONTH_REG = 0x05;
     static const uint8_t RTC_YEAR_REG = 0x06;
     static const uint8_t RTC_CONTROL_REG = 0x0E;
+    static const uint8_t RTC_TIME_REG_COUNT = 7; // Seconds through year
+    static const uint32_t DEFAULT_RESYNC_INTERVAL_S = 3600;
     
-    static String timeString;
-    static volatile bool timeCheckFlag;
+    static DisplayText timeString;
+    static Snapshot snapshot;
+    static std::atomic<uint32_t> sqwTicks; // Advanced by the SQW ISR
+    static uint32_t consumedTicks;         // Ticks already applied to snapshot
+    static uint32_t secondsSinceResync;
+    static uint32_t resyncIntervalSeconds;
     static int sqwPin;
     
     static uint8_t bcdToDecimal(uint8_t bcd);
     static uint8_t decimalToBcd(uint8_t decimal);
+    static bool readSnapshot(Snapshot& out);
+    static bool resync();
+    static void advanceSnapshot(uint32_t seconds);
+    static void publishTime();
     static void checkAndUpdateTime();
     static void IRAM_ATTR sqwInterrupt();
     
@@ -29,9 +52,11 @@ public:
     static void init(int sqwPin);
     static void enableSQWInterrupt();
     static void disableSQWInterrupt();
-    static String getTimeString();
+    static const DisplayText& getTimeString(); // " 745" style, 12-hour
     static void setTime(uint8_t hours, uint8_t minutes, uint8_t seconds);
     static void update(); // Call this in main loop to check for time changes
+    static const Snapshot& getSnapshot(); // Software-kept wall clock time
+    static void setResyncInterval(uint32_t seconds); // How often to re-read the RTC
     static uint8_t getCurrentHours();
     static uint8_t getCurrentMinutes();
     static uint16_t getMinutesSinceMidnight();
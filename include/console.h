@@ -0,0 +1,36 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+
+// Line-based diagnostic commands over Serial. Input wakes the event loop,
+// which runs any complete lines through poll().
+class Console {
+public:
+    static void init();
+    static void poll(); // Call on every loop wake
+
+private:
+    static const uint8_t LINE_SIZE = 64;
+
+    struct Command {
+        const char* name;
+        const char* help;
+        void (*run)(const char* args);
+    };
+    static const Command COMMANDS[];
+
+    static char line[LINE_SIZE];
+    static uint8_t lineLength;
+    static bool overflowed; // Line longer than LINE_SIZE, ignored when it ends
+
+    static void execute(char* text);
+    static void help(const char* args);
+    static void dumpEventLog(const char* args);
+    static void dumpBus(const char* args);
+#ifdef ENABLE_PROFILER
+    static void profile(const char* args);
+#endif
+};
+
+#endif // CONSOLE_H
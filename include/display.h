@@ -2,14 +2,45 @@
 #define DISPLAY_H
 
 #include <Arduino.h>
-#include <Wire.h>
-#include <SparkFun_Alphanumeric_Display.h>
+#include "display_text.h"
 
+// Four-digit 14-segment display on an HT16K33. Drawing calls only update a
+// RAM framebuffer; flush() sends the bytes that changed in one I2C write.
 class Display {
 public:
     static void init();
-    static HT16K33& getInstance();
     static void setBrightness(uint8_t brightness);
+
+    static void print(const char* text); // Left-aligned, blank padded
+    static void print(const DisplayText& text);
+    static void clear();                 // Blank all digits and the colon
+    static void setColon(bool on);
+    static void flush();                 // Call once per loop iteration
+
+    // Show a message over the framebuffer for durationMs without blocking.
+    // Drawing calls keep updating the framebuffer underneath, which comes
+    // back when the message expires or is cancelled (e.g. by user input).
+    static void showMessage(const char* text, uint32_t durationMs);
+    static void cancelMessage();
+    static void update(); // Expires messages; call from the main loop
+
+private:
+    static const uint8_t DIGITS = 4;
+    static const uint8_t RAM_SIZE = 16;
+    static const uint8_t COLON_ADDRESS = 0x01;
+
+    static uint8_t desiredRam[RAM_SIZE];
+    static uint8_t messageRam[RAM_SIZE];
+    static uint8_t shownRam[RAM_SIZE];
+    static bool messageActive;
+    static unsigned long messageStart;
+    static uint32_t messageDuration;
+    static bool shownValid; // False until the first full write
+
+    static bool sendCommand(uint8_t command, const char* site);
+    static uint16_t segmentsFor(char c);
+    static void setDigit(uint8_t ram[RAM_SIZE], uint8_t digit, uint16_t segments);
+    static void render(uint8_t ram[RAM_SIZE], const char* text);
 };
 
-#endif // DISPLAY_H
\ No newline at end of file
+#endif // DISPLAY_H
@@ -0,0 +1,38 @@
+#ifndef DISPLAY_TEXT_H
+#define DISPLAY_TEXT_H
+
+#include <Arduino.h>
+
+// Fixed-capacity text for the four-digit display. Lives on the stack, so
+// building a frame never touches the heap. Anything past CAPACITY is dropped.
+class DisplayText {
+public:
+    static const uint8_t CAPACITY = 4;
+
+    DisplayText();
+    DisplayText(const char* text);
+
+    DisplayText& append(char c);
+    DisplayText& append(const char* text);
+    // Right-aligned in width characters, padded with pad (width 0 = no padding)
+    DisplayText& appendNumber(uint16_t value, uint8_t width, char pad);
+
+    const char* c_str() const { return buffer; }
+    uint8_t size() const { return length; }
+    bool operator==(const DisplayText& other) const;
+    bool operator!=(const DisplayText& other) const { return !(*this == other); }
+
+    // Formatting helpers for the screens the clock shows
+    static DisplayText clockTime(uint8_t hours24, uint8_t minutes); // " 745", "1207"
+    static DisplayText hourWithMeridiem(uint8_t hours24, char pad); // "07PM" or " 7PM"
+    static DisplayText minutes(uint8_t minutes);                    // "M 05"
+    static DisplayText percent(uint8_t percent);                    // " 50%"
+    static DisplayText level(uint8_t level);                        // "03"
+    static DisplayText napMinutes(uint16_t minutes);                // "60", "300"
+
+private:
+    char buffer[CAPACITY + 1];
+    uint8_t length;
+};
+
+#endif // DISPLAY_TEXT_H
@@ -3,21 +3,60 @@
 
 #include <Arduino.h>
 #include <ESP32Encoder.h>
+#include <esp_timer.h>
+#include <atomic>
 #include "action.h"
+#include "spsc_ring.h"
 
 class Encoder {
 private:
-  static volatile bool buttonPressed;
-  static volatile unsigned long lastButtonTime;
-  static volatile bool lastButtonState;
-  static volatile bool buttonStateStable;
-  static unsigned long buttonPressStartTime;
-  static bool buttonHoldDetected;
+  // Timestamped input, esp_timer time truncated to 32 bits
+  struct InputEvent {
+    enum Type : uint8_t { ROTATE, PRESS, HOLD };
+    Type type;
+    uint32_t timestampUs;
+  };
+  static const uint8_t INPUT_EVENT_TYPES = 3;
+  static const uint16_t ROTATION_RING_SIZE = 16;
+  static const uint16_t BUTTON_RING_SIZE = 16;
+
+  // ROTATE is produced by the rotation ISR, one per burst (PCNT has the
+  // count). Button events are produced by the debounce timer callback.
+  static SpscRing<InputEvent, ROTATION_RING_SIZE> rotationEvents;
+  static SpscRing<InputEvent, BUTTON_RING_SIZE> buttonEvents;
+  static std::atomic<bool> rotationPending;
+
+  // Button recognizer, only touched from the esp_timer task
+  struct ButtonRecognizer {
+    uint8_t integrator;      // Debounce counter, 0 = released, max = pressed
+    bool pressed;            // Debounced state
+    bool holdFired;
+    uint32_t pressStartUs;
+  };
+  static ButtonRecognizer button;
+  static esp_timer_handle_t sampleTimer;
+  static std::atomic<bool> samplerRunning;
+  static std::atomic<uint32_t> lastEdgeUs;
+
+  static int64_t lastEncoderCount;
+  static uint32_t lastRotationUs;
+
+  // ISR-to-handler latency per event type
+  static uint32_t latencyCount[INPUT_EVENT_TYPES];
+  static uint64_t latencyTotal[INPUT_EVENT_TYPES];
+  static uint32_t latencyMax[INPUT_EVENT_TYPES];
 
   static void IRAM_ATTR buttonISR();
+  static void IRAM_ATTR rotationISR();
+  static void IRAM_ATTR startSampler();
+  static void sampleButton(void* arg);
+  static void emitButtonEvent(InputEvent::Type type, uint32_t timestampUs);
+  static void recordLatency(const InputEvent& input, uint32_t nowUs);
 public:
   static void init();
-  static Action getAction();
+  static ActionEvent getAction();
+  static int16_t accelerate(int16_t detents, uint16_t velocity); // Scale a burst by spin speed
+  static void logInputStats();
 };
 
-#endif // ENCODER_H
\ No newline at end of file
+#endif // ENCODER_H
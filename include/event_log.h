@@ -0,0 +1,73 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include "i2c_eeprom.h"
+
+// Persistent log of notable events in the 32 KB I2C EEPROM (24LC256).
+// Fixed-size records go round-robin over the whole device, so every cell is
+// rewritten once per lap, and each carries a sequence number so the head is
+// found at boot with a binary search instead of a full scan.
+class EventLog {
+public:
+    enum Type : uint8_t {
+        BOOT = 1,        // a = reset reason
+        I2C_ERROR,       // a = device address, b = Bus error code
+        STATE_CHANGE,    // a = previous StateId, b = new StateId
+        SCHEDULE_CHANGE, // a = previous block, b = new block, value = minute of week
+        SETTINGS_WRITE,  // a = NVS slot, value = image sequence
+    };
+
+    static bool init(); // Call once the bus is up
+    // Queue a record; written by update() from the main loop
+    static void record(Type type, uint8_t a = 0, uint8_t b = 0, uint32_t value = 0);
+    static void update();
+    static void dump(Print& out); // Every stored record, oldest first
+    static void logStats();
+
+private:
+    static const uint8_t I2C_ADDRESS = 0x57;
+    static const uint16_t DEVICE_SIZE = 32768;
+    static const uint8_t PAGE_SIZE = 64;
+    static const uint8_t RECORD_SIZE = 16; // Divides the page, so no record straddles two
+    static const uint8_t RECORDS_PER_PAGE = PAGE_SIZE / RECORD_SIZE;
+    static const uint16_t SLOT_COUNT = DEVICE_SIZE / RECORD_SIZE;
+    static const uint8_t DUMP_BATCH = 32;  // Records per burst read, 512 bytes
+    static const uint8_t QUEUE_SIZE = 8;
+    static const unsigned long WRITE_CYCLE_MS = 5;
+    static const unsigned long RETRY_MS = 1000;
+    static const unsigned long I2C_ERROR_HOLDOFF_MS = 60000; // Per repeated error
+
+    // Layout: sequence (4), uptime ms (4), type, a, b, value (4), CRC-8
+    struct Record {
+        uint32_t sequence;
+        uint32_t uptimeMs;
+        uint8_t type;
+        uint8_t a;
+        uint8_t b;
+        uint32_t value;
+    };
+
+    static I2cEeprom eeprom;
+    static bool available;
+    static uint32_t nextSequence;
+    static uint16_t headSlot; // Where the next queued record goes
+    static Record queue[QUEUE_SIZE];
+    static uint8_t queueHead;
+    static uint8_t queueCount;
+    static uint8_t lastI2cAddress;
+    static uint8_t lastI2cError;
+    static unsigned long lastI2cErrorMs;
+    static uint32_t recordsWritten;
+    static uint32_t recordsDropped;
+    static uint32_t writeErrors;
+    static uint32_t errorsSuppressed;
+
+    static bool isCurrentLap(uint16_t slot, uint32_t firstSequence, bool& ok);
+    static bool readSlot(uint16_t slot, uint8_t bytes[RECORD_SIZE]);
+    static void encode(const Record& record, uint8_t bytes[RECORD_SIZE]);
+    static bool decode(const uint8_t bytes[RECORD_SIZE], Record& record);
+    static void print(Print& out, const Record& record);
+};
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,45 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+// Wake-up sources for the main loop, combined as a bit mask
+enum EventBits : uint32_t {
+    EVENT_SQW_TICK = 1 << 0, // RTC square wave edge
+    EVENT_ENCODER  = 1 << 1, // Encoder rotated
+    EVENT_BUTTON   = 1 << 2, // Encoder switch changed
+    EVENT_TIMER    = 1 << 3, // Wake-up requested through wakeAfter()
+    EVENT_CONSOLE  = 1 << 4, // Serial input arrived
+};
+
+class Events {
+public:
+    static void init(); // Call from the task that runs loop()
+    static void post(uint32_t bits);
+    static void IRAM_ATTR postFromISR(uint32_t bits);
+    static uint32_t wait(); // Block until at least one event has been posted
+    static void wakeAfter(uint32_t ms); // Post EVENT_TIMER once, no later than ms from now
+
+    // Post-to-wakeup latency, measured from the first post after each wait
+    static uint32_t getAverageLatencyMicros();
+    static void logLatencyStats();
+
+private:
+    static TaskHandle_t loopTask;
+    static esp_timer_handle_t wakeTimer;
+    // 64-bit accesses tear on this core, so both are only touched under timeLock
+    static portMUX_TYPE timeLock;
+    static int64_t wakeDeadline;
+    static int64_t pendingSince;
+    static uint32_t wakeCount;
+    static uint64_t totalLatency;
+    static uint32_t maxLatency;
+
+    static void IRAM_ATTR markPending();
+    static void wakeTimerCallback(void* arg);
+};
+
+#endif // EVENTS_H
@@ -0,0 +1,75 @@
+#ifndef I2C_EEPROM_H
+#define I2C_EEPROM_H
+
+#include <Arduino.h>
+#include "bus.h"
+
+// Block device over a 24LC256-style I2C EEPROM: 16-bit addresses, page
+// writes that wrap within a page, and no ACK while a write cycle runs.
+// Small writes to the same page are combined into one page write, the
+// write cycle is waited out by ACK polling, and short reads go through a
+// small line cache. Long reads are burst straight off the bus.
+class I2cEeprom {
+public:
+    struct Stats {
+        uint32_t logicalWrites; // write() calls
+        uint32_t bytesWritten;  // Bytes passed to write()
+        uint32_t writeCycles;   // Page writes sent to the device
+        uint32_t ackPolls;      // Probes sent while a write cycle ran
+        uint32_t maxWaitMicros; // Longest wait for a write cycle
+        uint32_t cacheHits;
+        uint32_t cacheMisses;
+        uint32_t burstReads;    // Bus reads longer than a cache line
+        uint32_t busBytes;      // Everything clocked on the bus, address bytes included
+        uint32_t errors;
+    };
+
+    I2cEeprom(uint8_t deviceAddress, uint32_t size, uint16_t pageSize);
+
+    bool begin(); // True if the device answers
+    bool read(uint32_t address, uint8_t* data, size_t length);
+    // Buffered until a write lands on another page or flush() is called
+    bool write(uint32_t address, const uint8_t* data, size_t length);
+    bool flush();
+    bool isDirty() const { return pendingPage >= 0; }
+    bool isBusy(); // Still in a write cycle; a single poll, never waits
+    uint32_t getSize() const { return deviceSize; }
+    uint16_t getPageSize() const { return pageSize; }
+    const Stats& getStats() const { return stats; }
+    void logStats(const char* name) const;
+
+private:
+    static const uint16_t MAX_PAGE_SIZE = 64;
+    static const uint16_t LINE_SIZE = 32;
+    static const uint8_t CACHE_LINES = 4;
+    static const size_t MAX_BURST = 512;                 // Matches the bus buffer set up in setup()
+    static const uint32_t WRITE_CYCLE_TIMEOUT_US = 10000; // Twice the datasheet maximum
+
+    struct CacheLine {
+        uint32_t address;
+        bool valid;
+        uint8_t data[LINE_SIZE];
+    };
+
+    uint8_t deviceAddress;
+    uint32_t deviceSize;
+    uint16_t pageSize;
+    uint8_t page[MAX_PAGE_SIZE];
+    int32_t pendingPage; // Start of the buffered page, -1 if none
+    uint16_t dirtyStart; // Buffered byte range within the page, end exclusive
+    uint16_t dirtyEnd;
+    bool writeCycleRunning;
+    uint32_t writeStartMicros;
+    CacheLine cache[CACHE_LINES];
+    uint8_t nextVictim;
+    Stats stats;
+
+    void waitReady();
+    bool readBus(uint32_t address, uint8_t* data, size_t length);
+    void overlayPending(uint32_t address, uint8_t* data, size_t length) const;
+    void updateCache(uint32_t address, const uint8_t* data, size_t length);
+    void invalidateCache();
+    CacheLine* lookup(uint32_t lineAddress);
+};
+
+#endif // I2C_EEPROM_H
@@ -4,26 +4,224 @@
 #define MAIN_LOG 0
 
 #include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
+// Severity levels for the LOG_* macros and the per-module runtime levels
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_NOTICE  3
+#define LOG_LEVEL_INFO    4
+#define LOG_LEVEL_DEBUG   5
+
+// Calls above this level are removed by the preprocessor, arguments and
+// all. Set it with a build flag, e.g. -DLOG_COMPILE_LEVEL=LOG_LEVEL_ERROR.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Each source file that logs defines LOG_MODULE as one of these after its
+// includes; every module has its own runtime level.
+enum LogModule : uint8_t {
+    LOG_SYSTEM,
+    LOG_CLOCK,
+    LOG_SETTINGS,
+    LOG_INPUT,
+    LOG_DISPLAY,
+    LOG_LED,
+    LOG_MODULE_COUNT
+};
+
+// Each call site keeps its own rate-limit state (see Log::setRateLimit)
+#define LOG_AT(level, format, ...)                                          \
+    do {                                                                    \
+        static Log::Site logSite;                                           \
+        if (Log::isEnabled(LOG_MODULE, level) &&                            \
+            Log::admit(logSite, level, format)) {                           \
+            Log::write(level, format, ##__VA_ARGS__);                       \
+        }                                                                   \
+    } while (0)
+
+// Periodic reports are expected to repeat, so they skip the rate limit.
+// They log at DEBUG: raise a module's level to see its statistics.
+#define LOG_REPORT_AT(level, ...)                                           \
+    do {                                                                    \
+        if (Log::isEnabled(LOG_MODULE, level)) {                            \
+            Log::write(level, __VA_ARGS__);                                 \
+        }                                                                   \
+    } while (0)
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) LOG_AT(LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_NOTICE
+#define LOG_NOTICE(...) LOG_AT(LOG_LEVEL_NOTICE, __VA_ARGS__)
+#else
+#define LOG_NOTICE(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_REPORT(...) LOG_REPORT_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#define LOG_REPORT(...) do {} while (0)
+#endif
+
+// Log calls format into a lock-free ring and return; a low-priority task
+// drains the ring to Elog or Serial.
 class Log {
 public:
+    // What a log call does when the ring is full
+    enum class OverflowPolicy : uint8_t {
+        DROP,  // Discard the message and count it
+        BLOCK  // Wait for the drain task to free a slot (never from an ISR)
+    };
+
+    // Rate-limit state for one LOG_* call site, zero-initialized in place
+    struct Site {
+        uint32_t windowStart;
+        uint16_t inWindow;         // Messages let through this window
+        uint32_t suppressed;       // Dropped this window, reported when it ends
+        uint32_t totalSuppressed;
+        const char* format;
+        Site* next;                // All sites that have fired, for logStats()
+        bool registered;
+    };
+
     // Configuration
     static void init(bool useElog = true);
     static void setUseElog(bool enable);
+    static void setOverflowPolicy(OverflowPolicy policy);
+    // Binary mode ships the format ID and raw arguments instead of text;
+    // decode the serial stream with tools/log_decode.py
+    static void setBinaryMode(bool enable);
+    // Let at most burst NOTICE, INFO or DEBUG messages per call site through
+    // each window (burst 0 disables rate limiting)
+    static void setRateLimit(uint32_t windowMs, uint16_t burst);
+    // Identical consecutive messages within windowMs of each other are
+    // collapsed into "last message repeated N times"
+    static void setRepeatWindow(uint32_t windowMs);
     
-    // Logging methods
-    static void info(const char* format, ...);
-    static void error(const char* format, ...);
-    static void warning(const char* format, ...);
-    static void debug(const char* format, ...);
-    static void notice(const char* format, ...);
+    // Runtime level per module; messages above it are skipped before
+    // their arguments are evaluated
+    static void setModuleLevel(LogModule module, uint8_t level);
+    static uint8_t getModuleLevel(LogModule module);
+    static const char* getModuleName(LogModule module);
+    static inline bool isEnabled(LogModule module, uint8_t level) {
+        return level <= moduleLevels[module];
+    }
+
+    // Use the LOG_* macros rather than calling these directly
+    static bool admit(Site& site, uint8_t level, const char* format);
+    static void write(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    // Ring statistics
+    static uint32_t getDroppedCount();
+    static void logStats();
     
 private:
+    enum Level : uint8_t {
+        LEVEL_ERROR,
+        LEVEL_WARNING,
+        LEVEL_NOTICE,
+        LEVEL_INFO,
+        LEVEL_DEBUG,
+        LEVEL_COUNT
+    };
+
+    enum Kind : uint8_t {
+        KIND_TEXT,        // Formatted text in the text buffer
+        KIND_DEFINITION,  // Binary: format string for formatId, sent on first use
+        KIND_MESSAGE      // Binary: raw arguments for formatId in the text buffer
+    };
+
+    static const uint16_t RING_SIZE = 32; // Must be a power of two
+    static const uint16_t TEXT_SIZE = 128;
+    static const uint16_t FORMAT_SLOTS = 256; // Format IDs are one byte
+
+    // Slot sequence numbers make the ring safe for several producers: a
+    // slot is free for position p when sequence == p, and holds a message
+    // for the consumer when sequence == p + 1.
+    struct Record {
+        std::atomic<uint32_t> sequence;
+        uint32_t timestamp;
+        Level level;
+        Kind kind;
+        uint8_t formatId;
+        uint8_t length;      // Bytes of text used by binary records
+        bool truncated;      // Arguments did not fit
+        const char* format;  // Definition records only
+        char text[TEXT_SIZE];
+    };
+
+    static uint8_t moduleLevels[LOG_MODULE_COUNT];
     static bool useElog;
     static bool initialized;
-    static void logMessage(const char* level, const char* format, va_list args);
-    static void logWithElog(uint8_t elogLevel, const char* format, va_list args);
-    static void logWithSerial(const char* level, const char* format, va_list args);
+    static OverflowPolicy overflowPolicy;
+    static Record ring[RING_SIZE];
+    static std::atomic<uint32_t> enqueuePos;
+    static std::atomic<uint32_t> dequeuePos;
+    static std::atomic<uint32_t> writtenCount;
+    static std::atomic<uint32_t> droppedCount;
+    static std::atomic<uint32_t> peakDepth;
+    static TaskHandle_t drainTask;
+    static uint32_t rateWindowMs;
+    static uint16_t rateBurst;
+    static uint32_t repeatWindowMs;
+    static Site* sites;
+    static portMUX_TYPE siteLock;
+    static std::atomic<uint32_t> rateLimitedCount;
+    static uint32_t collapsedCount;
+
+    // Last message the drain task wrote, for repeat collapsing
+    struct Previous {
+        bool valid;
+        Kind kind;
+        Level level;
+        uint8_t formatId;
+        uint8_t length;
+        uint32_t timestamp;
+        uint32_t repeats;
+        char text[TEXT_SIZE];
+    };
+    static Previous previous;
+    static std::atomic<bool> binaryMode;
+    static const char* formats[FORMAT_SLOTS];
+    static bool announced[FORMAT_SLOTS];
+    static portMUX_TYPE formatLock;
+
+    static void logMessage(Level level, const char* format, va_list args);
+    static Record* claim(uint32_t& position);
+    static Record* claimSlot(uint32_t& position);
+    static void publish(Record* record, uint32_t position);
+    static bool logBinary(Level level, uint32_t timestamp, const char* format, va_list args);
+    static int lookupFormat(const char* format, bool& needsDefinition);
+    static void writeFrame(const Record& record);
+    static void drainRecord(const Record& record);
+    static bool isRepeat(const Record& record);
+    static void flushRepeats();
+    static void drainLoop(void* arg);
+    static void output(Level level, uint32_t timestamp, const char* text);
+    static void logWithElog(Level level, const char* text);
+    static void logWithSerial(Level level, uint32_t timestamp, const char* text);
 };
 
 #endif
@@ -0,0 +1,93 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Cycle-counter timing of the loop stages and of every state callback.
+// Built only with -DENABLE_PROFILER; otherwise the PROFILE_* macros expand
+// to nothing and none of this is compiled.
+#ifdef ENABLE_PROFILER
+
+#include <Arduino.h>
+#include "action.h"
+#include "states.h"
+
+class Profiler {
+public:
+    enum Stage : uint8_t {
+        STAGE_LOOP, // A whole loop pass, wait excluded
+        STAGE_CLOCK,
+        STAGE_INPUT,
+        STAGE_DISPATCH,
+        STAGE_SETTINGS,
+        STAGE_EVENT_LOG,
+        STAGE_DISPLAY,
+        STAGE_CONSOLE,
+        STAGE_COUNT
+    };
+
+    // Per-state slots: one per Action handler, then onEnter and onExit
+    static const uint8_t SLOT_ON_ENTER = ACTION_COUNT;
+    static const uint8_t SLOT_ON_EXIT = ACTION_COUNT + 1;
+    static const uint8_t STATE_SLOTS = ACTION_COUNT + 2;
+
+    static void init();
+    static inline uint32_t now() { return ESP.getCycleCount(); }
+    static void recordStage(Stage stage, uint32_t cycles);
+    static void recordState(StateId state, uint8_t slot, uint32_t cycles);
+    static void dump(Print& out);
+    static void reset();
+
+    // Times its own lifetime into a stage or state slot
+    class Scope {
+    public:
+        explicit Scope(Stage stage) : stage(stage), state(StateId::Count), slot(0), start(now()) {}
+        Scope(StateId state, uint8_t slot) : stage(STAGE_COUNT), state(state), slot(slot), start(now()) {}
+        ~Scope() {
+            uint32_t cycles = now() - start;
+            if (stage != STAGE_COUNT) {
+                recordStage(stage, cycles);
+            } else {
+                recordState(state, slot, cycles);
+            }
+        }
+
+    private:
+        Stage stage;
+        StateId state;
+        uint8_t slot;
+        uint32_t start;
+    };
+
+private:
+    // Bucket b counts durations in [2^(b-1), 2^b) us; the last is open-ended
+    static const uint8_t BUCKETS = 20;
+
+    struct Slot {
+        uint32_t count;
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint16_t histogram[BUCKETS]; // Saturates rather than wrapping
+    };
+
+    static Slot stages[STAGE_COUNT];
+    static Slot states[static_cast<uint8_t>(StateId::Count)][STATE_SLOTS];
+    static uint32_t cyclesPerMicro;
+
+    static void record(Slot& slot, uint32_t cycles);
+    static void print(Print& out, const char* name, const char* detail, const Slot& slot);
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// Time the rest of the enclosing block
+#define PROFILE_STAGE(stage) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(stage)
+#define PROFILE_STATE(state, slot) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(state, slot)
+
+#else
+
+#define PROFILE_STAGE(stage) do {} while (0)
+#define PROFILE_STATE(state, slot) do {} while (0)
+
+#endif // ENABLE_PROFILER
+
+#endif // PROFILER_H
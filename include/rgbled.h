@@ -3,17 +3,83 @@
 
 #include "schedule.h"
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
+// The NeoPixel ring is driven from its own task: callers only post the
+// target frame, and frames identical to the last one are dropped. Selected
+// block changes crossfade, stepped by a frame timer rather than loop().
 class RgbLed {
 public:
   static void init();
   static void indicateStatus(ScheduleBlock scheduleBlock);
   static void turnOff();
   static void setBrightness(uint8_t brightness);
+  static void logStats();
 
 private:
-  static void setColor(uint8_t red, uint8_t green, uint8_t blue);
+  struct Frame {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint8_t brightness;
+
+    bool operator==(const Frame& other) const {
+      return red == other.red && green == other.green && blue == other.blue &&
+             brightness == other.brightness;
+    }
+  };
+
+  // Owned by the LED task
+  struct Fade {
+    Frame from;
+    Frame to;
+    int64_t startUs;
+    bool active;
+  };
+
+  enum NotifyBits : uint32_t {
+    NOTIFY_FRAME = 1, // A new target frame is pending
+    NOTIFY_TICK = 2   // The fade timer fired
+  };
+
+  static const uint8_t SHOW_HISTOGRAM_BUCKETS = 12; // log2(us): <2, <4, ... >=2048
+  static const uint32_t FADE_DURATION_MS = 2000;
+  static const uint32_t FRAME_INTERVAL_US = 20000;     // 50 fps
+  static const uint32_t MAX_FRAME_INTERVAL_US = 160000; // Throttle no lower than ~6 fps
+  static const uint8_t CPU_BUDGET_PERCENT = 10;         // Of each frame interval
+
+  static void setColor(uint8_t red, uint8_t green, uint8_t blue, bool fade);
+  static void postFrame(bool fade);
+  static void ledTask(void* arg);
+  static void frameTimerCallback(void* arg);
+  static void startFade(const Frame& to);
+  static void stepFade();
+  static void stopFade();
+  static void render(const Frame& frame);
+
   static uint8_t currentBrightness;
+  static ScheduleBlock currentBlock;
+  static Frame target;       // Latest frame asked for by the loop
+  static Frame pending;      // Handed over to the LED task
+  static bool framePending;
+  static bool pendingFade;
+  static portMUX_TYPE frameLock;
+  static TaskHandle_t taskHandle;
+  static esp_timer_handle_t frameTimer;
+
+  static Frame shown;        // Last frame written to the pixels
+  static Fade fade;
+  static uint32_t frameIntervalUs;
+
+  static uint32_t framesRequested;
+  static uint32_t framesSkipped;
+  static uint32_t framesShown;
+  static uint32_t fadeFrames;
+  static uint32_t fadeThrottles;
+  static uint32_t maxFrameCostUs;
+  static uint32_t showHistogram[SHOW_HISTOGRAM_BUCKETS];
 };
 
-#endif // RGBLED_H
\ No newline at end of file
+#endif // RGBLED_H
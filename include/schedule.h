@@ -17,6 +17,7 @@ public:
   static Schedule getNap(uint8_t duration);
 
   static Schedule fromByteArray(const std::array<uint8_t, 10>& data);
+  static Schedule fromBoundaries(const std::array<uint16_t, 5>& boundaries);
   std::array<uint8_t, 10> convertToByteArray() const;
 
   void setWinddownStart(uint8_t hour, uint8_t minute);
@@ -38,6 +39,12 @@ public:
 
   bool isActive() const;
   ScheduleBlock getCurrentBlock() const;
+  ScheduleBlock getBlockAt(uint16_t minutesSinceMidnight) const;
+
+  // Block start/end times in minutes since midnight, in schedule order
+  std::array<uint16_t, 5> getBoundaries() const {
+    return {winddownStart, sleepStart, quietStart, wakeStart, wakeEnd};
+  }
 
 private:
   uint16_t winddownStart;
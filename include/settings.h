@@ -57,24 +57,78 @@ public:
     static bool setLocked(bool locked); // Set lock mode state
     static bool isLocked(); // Check if device is locked
     
-    // Brightness functions
+    // Brightness functions. Setters apply to RAM immediately; the NVS commit is
+    // deferred until the value has been left alone for COMMIT_QUIET_MS.
     static bool setDisplayBrightness(uint8_t brightness); // Set display brightness (0-15)
     static uint8_t getDisplayBrightness(); // Get display brightness
     static bool setLedBrightness(uint8_t brightness); // Set RGB LED brightness (0-255)
     static uint8_t getLedBrightness(); // Get RGB LED brightness
     
+    // Deferred writes: update() commits once the quiet period has passed,
+    // flush() commits immediately (e.g. on leaving an edit state)
+    static void update();
+    static void flush();
+    static void logWriteStats(); // Includes NVS reads, which should stay flat once booted
+    
     // Close preferences (call when shutting down)
     static void close();
 
 private:
+    // RAM copy of everything stored in NVS; getters are served from here
+    struct Cache {
+        Schedule schedules[7];
+        Schedule napSchedule;
+        bool napEnabled;
+        bool locked;
+        uint8_t displayBrightness;
+        uint8_t ledBrightness;
+    };
+    
+    // Values changed in RAM but not yet committed to NVS
+    enum PendingWrite : uint8_t {
+        PENDING_DISPLAY_BRIGHTNESS = 1 << 0,
+        PENDING_LED_BRIGHTNESS = 1 << 1,
+    };
+    static const unsigned long COMMIT_QUIET_MS = 2000;
+    
+    // All settings are stored as one CRC-protected image, alternating between
+    // two NVS slots so an interrupted commit leaves the previous image intact.
+    // Layout: version (1), sequence (4), bit-packed payload, CRC32 (4).
+    static const uint8_t IMAGE_VERSION = 1;
+    static const size_t IMAGE_PAYLOAD_SIZE = 62; // 8 schedules x 5 x 12 bits + flags + levels
+    static const size_t IMAGE_SIZE = 1 + 4 + IMAGE_PAYLOAD_SIZE + 4;
+    static const char* const IMAGE_SLOT_KEYS[2];
+    
     static Preferences preferences;
     static bool initialized;
+    static Cache cache;
+    static uint8_t activeSlot;     // Slot holding the newest valid image
+    static uint32_t imageSequence; // Sequence number of that image
+    static uint32_t nvsReads;
+    static uint32_t nvsWrites;
+    static uint8_t pendingWrites;
+    static unsigned long lastDeferredChange;
+    static uint32_t deferredRequests; // Setter calls that were deferred
+    static uint32_t deferredCommits;  // NVS writes those calls turned into
+    static uint32_t commitMicros;     // Time spent committing deferred writes
+    
+    static void deferWrite(PendingWrite write);
+    
+    // Write the whole cache to the inactive slot and make it the active one
+    static bool commit();
+    static void encodeImage(uint32_t sequence, uint8_t image[IMAGE_SIZE]);
+    static bool decodeImage(const uint8_t image[IMAGE_SIZE], size_t length, uint32_t& sequence, Cache& out);
     
     // Helper function to get the key name for a specific day
-    static String getDayKey(DayOfWeek day);
+    static const char* getDayKey(DayOfWeek day);
     
     // Initialize with default schedules if first time
     static void initializeDefaults();
+    
+    // Load the newest valid image, migrating from the per-key layout if needed
+    static bool loadImage();
+    static void migrateLegacyKeys();
+    static bool readScheduleBlob(const char* key, Schedule& schedule);
 };
 
 #endif // SETTINGS_H
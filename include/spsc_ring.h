@@ -0,0 +1,56 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Fixed-size single-producer/single-consumer queue. Neither side blocks or
+// takes a lock, so the producer can be an ISR. Indices run freely and are
+// masked on access, so all N slots are usable.
+template <typename T, uint16_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "ring size must be a power of two");
+
+public:
+    // Producer side. Forced inline so that calls from IRAM_ATTR handlers
+    // stay in IRAM.
+    inline __attribute__((always_inline)) bool push(const T& item) {
+        uint16_t currentHead = head.load(std::memory_order_relaxed);
+        uint16_t currentTail = tail.load(std::memory_order_acquire);
+        if ((uint16_t)(currentHead - currentTail) == N) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[currentHead & (N - 1)] = item;
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        uint16_t currentTail = tail.load(std::memory_order_relaxed);
+        uint16_t currentHead = head.load(std::memory_order_acquire);
+        if (currentHead == currentTail) {
+            return false;
+        }
+        item = items[currentTail & (N - 1)];
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+    }
+
+    uint32_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    T items[N];
+    std::atomic<uint16_t> head{0};
+    std::atomic<uint16_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
+#endif // SPSC_RING_H
@@ -9,8 +9,37 @@
 class StateMachine {
 public:
   static void init();
-  static void setState(State* newState);
-  static void processAction(Action action);
+  static void setState(StateId newState);
+  static StateId getState();
+  static const char* getStateName(StateId state);
+  static const char* getActionName(Action action);
+  // Events are queued and handled one at a time by dispatch(), so posting
+  // from inside a handler never re-enters the state machine
+  static void post(const ActionEvent& event);
+  static void post(Action action); // For events with no rotation payload
+  static void dispatch(); // Handle everything queued, in order
+  static void logQueueStats();
+  static uint16_t rotationDetents(); // Size of the burst being handled, at least 1
+  static uint16_t rotationSteps();   // The same burst after the acceleration curve
+
+private:
+  static const uint8_t QUEUE_SIZE = 8;
+
+  static void handle(const ActionEvent& event);
+
+  static ActionEvent queue[QUEUE_SIZE];
+  static uint8_t queueHead;
+  static uint8_t queueCount;
+  static uint8_t maxQueueDepth;
+  static uint32_t mergedEvents;
+  static uint32_t droppedEvents;
+  static uint32_t handledCount[ACTION_COUNT];
+  static uint64_t handleMicros[ACTION_COUNT];
+  static uint32_t maxHandleMicros[ACTION_COUNT];
+
+  static const State* currentState;
+  static StateId currentStateId;
+  static ActionEvent currentEvent;
 };
 
 #endif // STATE_MACHINE_H
\ No newline at end of file
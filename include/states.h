@@ -1,33 +1,85 @@
 #ifndef STATES_H
 #define STATES_H
 
+#include <stdint.h>
+#include "action.h"
+
+// How long transient messages ("LOCK", "DISP", ...) stay up
+const uint32_t MESSAGE_DURATION_MS = 1000;
+
+// Move value by delta steps, wrapping within [0, range)
+constexpr int wrapStep(int value, int delta, int range) {
+  return ((value + delta) % range + range) % range;
+}
+
+enum class StateId : uint8_t {
+  Clock,
+  Locked,
+  MenuTime,
+  MenuSchedule,
+  MenuNap,
+  MenuBrightness,
+  MenuLock,
+  MenuBack,
+  TimeSetHours,
+  TimeSetMinutes,
+  ScheduleSetSleepHours,
+  ScheduleSetSleepMinutes,
+  ScheduleSetQuietHours,
+  ScheduleSetQuietMinutes,
+  NapSetDuration,
+  SetDisplayBrightness,
+  SetColorBrightness,
+  Count
+};
+
+typedef void (*StateHandler)();
+
+// States are constexpr and live in flash. Dispatch indexes handlers by Action.
 struct State {
-  void (*OnEnter)();
-  void (*OnExit)();
-
-  void (*OnClockwise)();
-  void (*OnCounterClockwise)();
-  void (*OnSelect)();
-  void (*OnSelectHold)();
-  void (*OnTimeChange)();
+  StateHandler onEnter;
+  StateHandler onExit;
+  StateHandler handlers[ACTION_COUNT];
 };
 
-extern State Clock;
-extern State Locked;
-extern State MenuTime;
-extern State MenuSchedule;
-extern State MenuNap;
-extern State MenuBrightness;
-extern State MenuLock;
-extern State MenuBack;
-extern State TimeSetHours;
-extern State TimeSetMinutes;
-extern State ScheduleSetSleepHours;
-extern State ScheduleSetSleepMinutes;
-extern State ScheduleSetQuietHours;
-extern State ScheduleSetQuietMinutes;
-extern State NapSetDuration;
-extern State SetDisplayBrightness;
-extern State SetColorBrightness;
+// Named handler slots, so states can be written with designated initializers
+struct StateHandlers {
+  StateHandler OnEnter;
+  StateHandler OnExit;
+
+  StateHandler OnClockwise;
+  StateHandler OnCounterClockwise;
+  StateHandler OnSelect;
+  StateHandler OnSelectHold;
+  StateHandler OnTimeChange;
+};
+
+static_assert(NONE == 0 && CW == 1 && CCW == 2 && SELECT == 3 && SELECT_HOLD == 4 &&
+              TIME_CHANGE == 5 && ACTION_COUNT == 6,
+              "defineState() lists handlers in Action order");
+
+constexpr State defineState(const StateHandlers& h) {
+  return State{h.OnEnter, h.OnExit,
+               {nullptr, h.OnClockwise, h.OnCounterClockwise, h.OnSelect,
+                h.OnSelectHold, h.OnTimeChange}};
+}
+
+extern const State Clock;
+extern const State Locked;
+extern const State MenuTime;
+extern const State MenuSchedule;
+extern const State MenuNap;
+extern const State MenuBrightness;
+extern const State MenuLock;
+extern const State MenuBack;
+extern const State TimeSetHours;
+extern const State TimeSetMinutes;
+extern const State ScheduleSetSleepHours;
+extern const State ScheduleSetSleepMinutes;
+extern const State ScheduleSetQuietHours;
+extern const State ScheduleSetQuietMinutes;
+extern const State NapSetDuration;
+extern const State SetDisplayBrightness;
+extern const State SetColorBrightness;
 
 #endif
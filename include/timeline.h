@@ -0,0 +1,38 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <Arduino.h>
+#include "schedule.h"
+
+// Tracks the active schedule block and when it next changes, so the
+// per-minute path is a countdown check instead of a schedule evaluation.
+class Timeline {
+public:
+    static const uint16_t MINUTES_PER_DAY = 24 * 60;
+    static const uint16_t MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+
+    // Full recompute; call after a schedule edit, nap start/stop or time set
+    static void rebuild();
+    // Call once per minute change; only rebuilds when a transition is due
+    static void onMinute();
+
+    static ScheduleBlock getCurrentBlock();
+
+    // Pure computation over a week of schedules and an optional active nap.
+    // Returns the block at minuteOfWeek and fills in the first minute of week
+    // at which it changes (or minuteOfWeek itself if it never changes).
+    static ScheduleBlock compute(const Schedule week[7], const Schedule* nap, uint16_t minuteOfWeek,
+                                 uint16_t& nextTransition, ScheduleBlock& nextBlock);
+
+private:
+    static ScheduleBlock currentBlock;
+    static ScheduleBlock nextBlock;
+    static uint16_t nextTransition;   // Minute of week (0 = Sunday 00:00)
+    static uint16_t lastMinute;       // Minute of week seen by the last update
+    static uint16_t minutesRemaining; // Until nextTransition
+
+    static uint16_t currentMinuteOfWeek();
+    static ScheduleBlock blockAt(const Schedule week[7], const Schedule* nap, uint16_t minuteOfWeek);
+};
+
+#endif // TIMELINE_H
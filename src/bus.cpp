@@ -0,0 +1,156 @@
+#include "bus.h"
+#include "logging.h"
+#include <Wire.h>
+
+#define LOG_MODULE LOG_SYSTEM
+
+// Static member definitions
+Bus::Device Bus::devices[Bus::MAX_DEVICES];
+uint8_t Bus::deviceCount = 0;
+Bus::Site Bus::sites[Bus::MAX_SITES];
+uint8_t Bus::siteCount = 0;
+uint32_t Bus::untracked = 0;
+unsigned long Bus::windowStart = 0;
+
+void Bus::begin(int sda, int scl, size_t bufferSize) {
+    Wire.begin(sda, scl);
+    Wire.setBufferSize(bufferSize);
+    windowStart = millis();
+}
+
+uint8_t Bus::probe(uint8_t address, const char* site) {
+    return write(address, nullptr, 0, site);
+}
+
+uint8_t Bus::write(uint8_t address, const uint8_t* data, size_t length, const char* site) {
+    uint32_t start = micros();
+    Wire.beginTransmission(address);
+    if (length > 0) {
+        Wire.write(data, length);
+    }
+    uint8_t error = Wire.endTransmission();
+    account(address, site, 1 + length, error, micros() - start);
+    return error;
+}
+
+uint8_t Bus::read(uint8_t address, const uint8_t* command, size_t commandLength,
+                  uint8_t* data, size_t length, const char* site) {
+    uint32_t start = micros();
+    uint8_t error = 0;
+    size_t bytes = 0;
+    if (commandLength > 0) {
+        Wire.beginTransmission(address);
+        Wire.write(command, commandLength);
+        error = Wire.endTransmission(false);
+        bytes += 1 + commandLength;
+    }
+    if (error == 0) {
+        size_t received = Wire.requestFrom(address, length, true);
+        bytes += 1 + received;
+        if (received < length) {
+            error = ERROR_SHORT_READ;
+        } else {
+            Wire.readBytes(data, length);
+        }
+    }
+    account(address, site, bytes, error, micros() - start);
+    return error;
+}
+
+// Linear lookups: a handful of devices and a couple of dozen call sites
+void Bus::account(uint8_t address, const char* site, size_t bytes, uint8_t error, uint32_t elapsed) {
+    Device* device = nullptr;
+    for (uint8_t i = 0; i < deviceCount && device == nullptr; i++) {
+        if (devices[i].address == address) {
+            device = &devices[i];
+        }
+    }
+    if (device == nullptr && deviceCount < MAX_DEVICES) {
+        device = &devices[deviceCount++];
+        *device = {};
+        device->address = address;
+    }
+
+    Site* entry = nullptr;
+    for (uint8_t i = 0; i < siteCount && entry == nullptr; i++) {
+        if (sites[i].name == site && sites[i].address == address) {
+            entry = &sites[i];
+        }
+    }
+    if (entry == nullptr && siteCount < MAX_SITES) {
+        entry = &sites[siteCount++];
+        *entry = {};
+        entry->name = site;
+        entry->address = address;
+    }
+
+    if (device == nullptr || entry == nullptr) {
+        untracked++;
+    }
+    if (device != nullptr) {
+        add(device->window, bytes, error, elapsed);
+        add(device->total, bytes, error, elapsed);
+    }
+    if (entry != nullptr) {
+        add(entry->window, bytes, error, elapsed);
+        add(entry->total, bytes, error, elapsed);
+    }
+}
+
+void Bus::add(Counters& counters, size_t bytes, uint8_t error, uint32_t elapsed) {
+    counters.transactions++;
+    counters.bytes += bytes;
+    counters.nacks += (error != 0);
+    counters.micros += elapsed;
+}
+
+void Bus::logStats() {
+    unsigned long windowMs = millis() - windowStart;
+    windowStart = millis();
+
+    uint32_t busyMicros = 0;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        busyMicros += devices[i].window.micros;
+    }
+    // Share of the window spent in transactions, in tenths of a percent
+    [[maybe_unused]] uint32_t permille = windowMs ? (uint32_t)((uint64_t)busyMicros / windowMs) : 0;
+    LOG_REPORT("I2C bus: %lu us busy in the last %lu s (%lu.%lu%%)",
+                (unsigned long)busyMicros, (unsigned long)(windowMs / 1000),
+                (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        [[maybe_unused]] const Counters& counters = devices[i].window;
+        LOG_REPORT("  0x%02x: %lu transactions, %lu bytes, %lu NACKs, %lu us", devices[i].address,
+                    (unsigned long)counters.transactions, (unsigned long)counters.bytes,
+                    (unsigned long)counters.nacks, (unsigned long)counters.micros);
+        devices[i].window = {};
+    }
+    for (uint8_t i = 0; i < siteCount; i++) {
+        [[maybe_unused]] const Counters& counters = sites[i].window;
+        if (counters.transactions > 0) {
+            LOG_REPORT("  %s (0x%02x): %lu transactions, %lu bytes, %lu NACKs, %lu us", sites[i].name,
+                        sites[i].address, (unsigned long)counters.transactions, (unsigned long)counters.bytes,
+                        (unsigned long)counters.nacks, (unsigned long)counters.micros);
+        }
+        sites[i].window = {};
+    }
+}
+
+void Bus::dump(Print& out) {
+    out.printf("I2C bus totals since boot\n");
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        const Counters& counters = devices[i].total;
+        out.printf("  0x%02x: %lu transactions, %lu bytes, %lu NACKs, %lu us\n", devices[i].address,
+                   (unsigned long)counters.transactions, (unsigned long)counters.bytes,
+                   (unsigned long)counters.nacks, (unsigned long)counters.micros);
+    }
+    for (uint8_t i = 0; i < siteCount; i++) {
+        const Counters& counters = sites[i].total;
+        out.printf("  %-16s 0x%02x: %lu transactions, %lu bytes, %lu NACKs, %lu us\n", sites[i].name,
+                   sites[i].address, (unsigned long)counters.transactions, (unsigned long)counters.bytes,
+                   (unsigned long)counters.nacks, (unsigned long)counters.micros);
+    }
+    if (untracked > 0) {
+        out.printf("  %lu transactions not tracked (tables full)\n", (unsigned long)untracked);
+    }
+}
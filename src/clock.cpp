@@ -1,13 +1,23 @@
 #include "clock.h"
+#include "bus.h"
+#include "events.h"
+#include "event_log.h"
 #include "logging.h"
 #include "rgbled.h"
 #include "schedule.h"
 #include "settings.h"
 #include "state_machine.h"
+#include "timeline.h"
+
+#define LOG_MODULE LOG_CLOCK
 
 // Static member definitions
-String Clock::timeString = "0000";
-volatile bool Clock::timeCheckFlag = false;
+DisplayText Clock::timeString("0000");
+Clock::Snapshot Clock::snapshot = {0, 0, 0, 0, 1, 1, 2025};
+std::atomic<uint32_t> Clock::sqwTicks(0);
+uint32_t Clock::consumedTicks = 0;
+uint32_t Clock::secondsSinceResync = 0;
+uint32_t Clock::resyncIntervalSeconds = Clock::DEFAULT_RESYNC_INTERVAL_S;
 int Clock::sqwPin = -1;
 
 void Clock::init(int pin) {
@@ -15,106 +25,193 @@ void Clock::init(int pin) {
     pinMode(sqwPin, INPUT_PULLUP);
     
     // Configure RTC to output 1Hz square wave on SQW pin
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_CONTROL_REG);
-    Wire.write(0x10); // Enable SQW, 1Hz output
-    Wire.endTransmission();
+    const uint8_t control[] = {RTC_CONTROL_REG, 0x10}; // Enable SQW, 1Hz output
+    Bus::write(RTC_ADDRESS, control, sizeof(control), "rtc-sqw");
     
     // Read initial time
     checkAndUpdateTime();
 
-    Log::info("Clock initialized");
+    LOG_INFO("Clock initialized");
 }
 
 void Clock::enableSQWInterrupt() {
     if (sqwPin != -1) {
         attachInterrupt(digitalPinToInterrupt(sqwPin), sqwInterrupt, FALLING);
-        Log::info("SQW interrupt enabled");
+        LOG_INFO("SQW interrupt enabled");
     }
 }
 
 void Clock::disableSQWInterrupt() {
     if (sqwPin != -1) {
         detachInterrupt(digitalPinToInterrupt(sqwPin));
-        Log::info("SQW interrupt disabled");
+        LOG_INFO("SQW interrupt disabled");
     }
 }
 
 void IRAM_ATTR Clock::sqwInterrupt() {
-    timeCheckFlag = true;
+    sqwTicks.fetch_add(1, std::memory_order_relaxed);
+    Events::postFromISR(EVENT_SQW_TICK);
 }
 
+// The SQW pin ticks once per second, so the wall clock is kept in RAM and
+// only re-read from the RTC every resyncIntervalSeconds. Ticks accumulate
+// while the loop is stalled and are all applied on the next call.
 void Clock::update() {
-    if (timeCheckFlag) {
-        timeCheckFlag = false;
-        checkAndUpdateTime();
+    uint32_t ticks = sqwTicks.load(std::memory_order_relaxed);
+    uint32_t elapsed = ticks - consumedTicks;
+    if (elapsed == 0) {
+        return;
+    }
+    consumedTicks = ticks;
+    secondsSinceResync += elapsed;
+
+    if (secondsSinceResync >= resyncIntervalSeconds) {
+        if (resync()) {
+            publishTime();
+            return;
+        }
+        // Keep counting on the SQW ticks and retry on the next one
+        LOG_ERROR("Error reading from RTC, retrying next tick");
     }
+    advanceSnapshot(elapsed);
+    publishTime();
 }
 
-String Clock::getTimeString() {
+void Clock::setResyncInterval(uint32_t seconds) {
+    resyncIntervalSeconds = (seconds == 0) ? 1 : seconds;
+    LOG_INFO("RTC resync interval set to %lu seconds", (unsigned long)resyncIntervalSeconds);
+}
+
+const DisplayText& Clock::getTimeString() {
     return timeString;
 }
 
 void Clock::setTime(uint8_t hours, uint8_t minutes, uint8_t seconds) {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_SECONDS_REG);
-    Wire.write(decimalToBcd(seconds));
-    Wire.write(decimalToBcd(minutes));
-    Wire.write(decimalToBcd(hours));
-    Wire.endTransmission();
+    const uint8_t time[] = {RTC_SECONDS_REG, decimalToBcd(seconds), decimalToBcd(minutes), decimalToBcd(hours)};
+    Bus::write(RTC_ADDRESS, time, sizeof(time), "rtc-set");
     
-    // Update our local time string immediately
-    checkAndUpdateTime();
+    // Rebuild before publishing: the minute change then finds the timeline
+    // current instead of rebuilding it a second time
+    if (resync()) {
+        Timeline::rebuild();
+        publishTime();
+    } else {
+        LOG_ERROR("Error reading from RTC");
+    }
 
-    Log::info("Time set to %02d:%02d:%02d", hours, minutes, seconds);
+    LOG_INFO("Time set to %02d:%02d:%02d", hours, minutes, seconds);
 }
 
 void Clock::checkAndUpdateTime() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_SECONDS_REG);
-    Wire.endTransmission();
+    if (!resync()) {
+        LOG_ERROR("Error reading from RTC");
+        return;
+    }
+    publishTime();
+}
+
+// Reload the snapshot from the RTC. The tick counter is sampled around the
+// read so an SQW edge landing mid-read is not applied twice.
+bool Clock::resync() {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint32_t ticksBefore = sqwTicks.load(std::memory_order_relaxed);
+        Snapshot fresh;
+        if (!readSnapshot(fresh)) {
+            return false;
+        }
+        uint32_t ticksAfter = sqwTicks.load(std::memory_order_relaxed);
+        if (ticksBefore == ticksAfter) {
+            snapshot = fresh;
+            consumedTicks = ticksAfter;
+            secondsSinceResync = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Roll the snapshot forward, carrying through the calendar the same way the
+// RTC does (including its 1-7 day-of-week counter)
+void Clock::advanceSnapshot(uint32_t seconds) {
+    static const uint8_t daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    uint32_t total = snapshot.seconds + seconds;
+    snapshot.seconds = total % 60;
+    total = snapshot.minutes + total / 60;
+    snapshot.minutes = total % 60;
+    total = snapshot.hours + total / 60;
+    snapshot.hours = total % 24;
+    uint32_t days = total / 24;
+
+    while (days > 0) {
+        days--;
+        snapshot.dayOfWeek = (snapshot.dayOfWeek >= 7) ? 1 : snapshot.dayOfWeek + 1;
+
+        uint8_t monthIndex = (snapshot.month >= 1 && snapshot.month <= 12) ? snapshot.month - 1 : 0;
+        uint8_t monthLength = daysInMonth[monthIndex];
+        if (monthIndex == 1 && snapshot.year % 4 == 0) {
+            monthLength = 29;
+        }
+        if (++snapshot.date > monthLength) {
+            snapshot.date = 1;
+            if (++snapshot.month > 12) {
+                snapshot.month = 1;
+                snapshot.year++;
+            }
+        }
+    }
+}
+
+// Refresh the display string and fire TIME_CHANGE when the minute rolls over
+void Clock::publishTime() {
+    [[maybe_unused]] uint8_t seconds = snapshot.seconds; // Logging only
+    uint8_t minutes = snapshot.minutes;
+    uint8_t hours24 = snapshot.hours;
     
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)3);
+    DisplayText newTimeString = DisplayText::clockTime(hours24, minutes);
     
-    if (Wire.available() >= 3) {
-        uint8_t seconds = bcdToDecimal(Wire.read());
-        uint8_t minutes = bcdToDecimal(Wire.read());
-        uint8_t hours24 = bcdToDecimal(Wire.read());
+    // Only update if the time string has changed
+    if (newTimeString != timeString) {
+        timeString = newTimeString;
+        StateMachine::post(TIME_CHANGE);
         
-        // Convert to 12-hour format
-        uint8_t hours12 = hours24;
-        if (hours12 == 0) {
-            hours12 = 12; // Midnight case (00:xx becomes 12:xx AM)
-        } else if (hours12 > 12) {
-            hours12 -= 12; // PM case (13:xx becomes 1:xx PM, etc.)
-        }
+        // Schedule work only happens when the timeline reaches a transition
+        Timeline::onMinute();
         
-        // Format as HHMM string in 12-hour format
-        char timeBuffer[4];
-        sprintf(timeBuffer, "%02d%02d", hours12, minutes);
-        if (timeBuffer[0] == '0') {
-            timeBuffer[0] = ' ';
-        }
-        String newTimeString = String(timeBuffer);
-        
-        // Only update if the time string has changed
-        if (newTimeString != timeString) {
-            timeString = newTimeString;
-            StateMachine::processAction(TIME_CHANGE);
-            
-            // Update RGB LED based on schedule when minute changes
-            updateScheduleLED();
-            
-            // Logging
-            const char* ampm = (hours24 < 12) ? "AM" : "PM";
-            Log::info("Time updated: %02d:%02d:%02d %s (String: %s)", 
-                          hours12, minutes, seconds, ampm, timeString.c_str());
-        }
-    } else {
-        Log::error("Error reading from RTC");
+        // Logging
+        [[maybe_unused]] uint8_t hours12 = (hours24 % 12 == 0) ? 12 : hours24 % 12;
+        [[maybe_unused]] const char* ampm = (hours24 < 12) ? "AM" : "PM";
+        LOG_INFO("Time updated: %02d:%02d:%02d %s (String: %s)", 
+                      hours12, minutes, seconds, ampm, timeString.c_str());
     }
 }
 
+// Read all seven time registers in one write/repeated-start/read transaction
+bool Clock::readSnapshot(Snapshot& out) {
+    const uint8_t reg = RTC_SECONDS_REG;
+    uint8_t raw[RTC_TIME_REG_COUNT];
+    uint8_t error = Bus::read(RTC_ADDRESS, &reg, 1, raw, RTC_TIME_REG_COUNT, "rtc-read");
+    if (error != 0) {
+        EventLog::record(EventLog::I2C_ERROR, RTC_ADDRESS, error);
+        return false;
+    }
+    
+    out.seconds = bcdToDecimal(raw[RTC_SECONDS_REG] & 0x7F);
+    out.minutes = bcdToDecimal(raw[RTC_MINUTES_REG] & 0x7F);
+    out.hours = bcdToDecimal(raw[RTC_HOURS_REG] & 0x3F);
+    out.dayOfWeek = bcdToDecimal(raw[RTC_DAY_OF_WEEK_REG] & 0x07);
+    out.date = bcdToDecimal(raw[RTC_DATE_REG] & 0x3F);
+    // Mask out the century bit (bit 7) before converting
+    out.month = bcdToDecimal(raw[RTC_MONTH_REG] & 0x7F);
+    // DS3231 stores only 2-digit year, add 2000 to get full year
+    out.year = 2000 + bcdToDecimal(raw[RTC_YEAR_REG]);
+    return true;
+}
+
+const Clock::Snapshot& Clock::getSnapshot() {
+    return snapshot;
+}
+
 uint8_t Clock::bcdToDecimal(uint8_t bcd) {
     return ((bcd >> 4) * 10) + (bcd & 0x0F);
 }
@@ -123,141 +220,46 @@ uint8_t Clock::decimalToBcd(uint8_t decimal) {
     return ((decimal / 10) << 4) + (decimal % 10);
 }
 
+// The getCurrent*() accessors are served from the snapshot taken on the
+// last SQW tick (or setTime), so they never touch the I2C bus.
 uint8_t Clock::getCurrentHours() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_HOURS_REG);
-    Wire.endTransmission();
-    
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)1);
-    if (Wire.available()) {
-        return bcdToDecimal(Wire.read());
-    }
-    return 0;
+    return snapshot.hours;
 }
 
 uint8_t Clock::getCurrentMinutes() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_MINUTES_REG);
-    Wire.endTransmission();
-    
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)1);
-    if (Wire.available()) {
-        return bcdToDecimal(Wire.read());
-    }
-    return 0;
+    return snapshot.minutes;
 }
 
 uint16_t Clock::getMinutesSinceMidnight() {
-    uint16_t hours = getCurrentHours();
-    uint16_t minutes = getCurrentMinutes();
-    return hours * 60 + minutes;
+    return snapshot.hours * 60 + snapshot.minutes;
 }
 
 uint8_t Clock::getCurrentDayOfWeek() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_DAY_OF_WEEK_REG);
-    Wire.endTransmission();
-    
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)1);
-    if (Wire.available()) {
-        uint8_t day = bcdToDecimal(Wire.read());
-        return day;
-    }
-    return 0; // Default to Sunday
+    return snapshot.dayOfWeek;
 }
 
 uint8_t Clock::getCurrentDate() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_DATE_REG);
-    Wire.endTransmission();
-    
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)1);
-    if (Wire.available()) {
-        return bcdToDecimal(Wire.read());
-    }
-    return 1; // Default to 1st of month
+    return snapshot.date;
 }
 
 uint8_t Clock::getCurrentMonth() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_MONTH_REG);
-    Wire.endTransmission();
-    
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)1);
-    if (Wire.available()) {
-        uint8_t monthByte = Wire.read();
-        // Mask out the century bit (bit 7) and convert BCD to decimal
-        return bcdToDecimal(monthByte & 0x7F);
-    }
-    return 1; // Default to January
+    return snapshot.month;
 }
 
 uint16_t Clock::getCurrentYear() {
-    Wire.beginTransmission(RTC_ADDRESS);
-    Wire.write(RTC_YEAR_REG);
-    Wire.endTransmission();
-    
-    Wire.requestFrom(RTC_ADDRESS, (uint8_t)1);
-    if (Wire.available()) {
-        uint8_t yearByte = bcdToDecimal(Wire.read());
-        // DS3231 stores only 2-digit year, add 2000 to get full year
-        return 2000 + yearByte;
-    }
-    return 2025; // Default to current year
+    return snapshot.year;
 }
 
-// Helper function to check current schedule phase and update RGB LED
+// Recompute the schedule block from scratch and update the RGB LED
 void Clock::updateScheduleLED() {
-    uint8_t currentHour = getCurrentHours();
-    uint8_t currentMinute = getCurrentMinutes();
-    uint8_t dayOfWeek = getCurrentDayOfWeek();
-    
-    // Convert current time to minutes since midnight
-    int currentMinutes = currentHour * 60 + currentMinute;
-    
-    // Check if there's an active nap first - naps take priority
-    Schedule napSchedule;
-    bool hasActiveNap = Settings::isNapEnabled() && Settings::loadNapSchedule(napSchedule);
-    
-    if (hasActiveNap) {
-        Log::info("Active nap detected, using nap schedule");
-
-        // Use the Schedule class's getCurrentBlock method to determine phase
-        ScheduleBlock currentBlock = napSchedule.getCurrentBlock();
-        
-        Log::info("Nap Schedule: Current block = %d", currentBlock);
-                    
-        // Set LED color based on nap phase
-        RgbLed::indicateStatus(currentBlock);
-        if (currentBlock == NO_BLOCK) {
-            // If nap is over, deactivate it
-            Log::info("Nap period ended, deactivating nap");
-            Settings::stopNap();
-            RgbLed::turnOff();
-            return; // Exit early since nap is over
-        }
-        
-        return; // Exit early since we're using nap schedule
-    }
-    
-    // No active nap, use regular daily schedule
-    Schedule todaySchedule;
-    Settings::loadSchedule(static_cast<DayOfWeek>(dayOfWeek), todaySchedule);
-    
-    // Use the Schedule class's getCurrentBlock method
-    ScheduleBlock currentBlock = todaySchedule.getCurrentBlock();
-
-    Log::info("Current time: %02d:%02d, Day: %d", currentHour, currentMinute, dayOfWeek);
-    Log::info("Daily Schedule: Current block = %d", currentBlock);
-    
-    RgbLed::indicateStatus(currentBlock);
+    Timeline::rebuild();
 }
 
 bool Clock::startNap(uint16_t durationMinutes) {
-    uint8_t currentHour = getCurrentHours();
-    uint8_t currentMinute = getCurrentMinutes();
+    [[maybe_unused]] uint8_t currentHour = getCurrentHours();
+    [[maybe_unused]] uint8_t currentMinute = getCurrentMinutes();
 
-    Log::info("Starting nap at %02d:%02d for %d minutes", currentHour, currentMinute, durationMinutes);
+    LOG_INFO("Starting nap at %02d:%02d for %d minutes", currentHour, currentMinute, durationMinutes);
 
     // Use the Schedule class to create a nap schedule
     Schedule napSchedule = Schedule::getNap(durationMinutes);
@@ -266,7 +268,7 @@ bool Clock::startNap(uint16_t durationMinutes) {
     bool success = Settings::saveNapSchedule(napSchedule) && Settings::setNapEnabled(true);
     
     if (success) {
-        Log::info("Nap schedule created and enabled for %d minutes", durationMinutes);
+        LOG_INFO("Nap schedule created and enabled for %d minutes", durationMinutes);
 
         // Update LED immediately
         updateScheduleLED();
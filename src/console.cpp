@@ -0,0 +1,98 @@
+#include "console.h"
+#include "bus.h"
+#include "event_log.h"
+#include "events.h"
+#include "profiler.h"
+#include <cstring>
+
+// Static member definitions
+char Console::line[Console::LINE_SIZE];
+uint8_t Console::lineLength = 0;
+bool Console::overflowed = false;
+
+const Console::Command Console::COMMANDS[] = {
+    {"help", "List commands", help},
+    {"log", "Dump the persistent event log, oldest first", dumpEventLog},
+    {"bus", "Show I2C traffic per device and call site since boot", dumpBus},
+#ifdef ENABLE_PROFILER
+    {"prof", "Show loop and state timings; 'prof reset' clears them", profile},
+#endif
+};
+
+void Console::init() {
+#if ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+    // Serial is the S3's USB Serial/JTAG (HWCDC), which only has onEvent();
+    // the handler runs in its event task
+    Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, [](void*, esp_event_base_t, int32_t, void*) {
+        Events::post(EVENT_CONSOLE);
+    });
+#elif ARDUINO_USB_CDC_ON_BOOT
+    // Serial is TinyUSB CDC
+    Serial.onEvent(ARDUINO_USB_CDC_RX_EVENT, [](void*, esp_event_base_t, int32_t, void*) {
+        Events::post(EVENT_CONSOLE);
+    });
+#else
+    // Runs in the UART driver's task once input goes idle
+    Serial.onReceive([]() { Events::post(EVENT_CONSOLE); });
+#endif
+}
+
+void Console::poll() {
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+        if (c == '\r' || c == '\n') {
+            if (lineLength > 0 && !overflowed) {
+                line[lineLength] = '\0';
+                execute(line);
+            }
+            lineLength = 0;
+            overflowed = false;
+        } else if (lineLength < LINE_SIZE - 1) {
+            line[lineLength++] = c;
+        } else {
+            overflowed = true;
+        }
+    }
+}
+
+void Console::execute(char* text) {
+    char* args = strchr(text, ' ');
+    if (args != nullptr) {
+        *args++ = '\0';
+    } else {
+        args = text + strlen(text);
+    }
+
+    for (const Command& command : COMMANDS) {
+        if (strcmp(text, command.name) == 0) {
+            command.run(args);
+            return;
+        }
+    }
+    Serial.printf("Unknown command '%s', try 'help'\n", text);
+}
+
+void Console::help(const char* args) {
+    for (const Command& command : COMMANDS) {
+        Serial.printf("  %-8s %s\n", command.name, command.help);
+    }
+}
+
+void Console::dumpEventLog(const char* args) {
+    EventLog::dump(Serial);
+}
+
+void Console::dumpBus(const char* args) {
+    Bus::dump(Serial);
+}
+
+#ifdef ENABLE_PROFILER
+void Console::profile(const char* args) {
+    if (strcmp(args, "reset") == 0) {
+        Profiler::reset();
+        Serial.printf("Profile cleared\n");
+    } else {
+        Profiler::dump(Serial);
+    }
+}
+#endif
@@ -1,30 +1,222 @@
 #include "display.h"
 #include "settings.h"
 #include "logging.h"
+#include "event_log.h"
+#include "events.h"
+#include "bus.h"
+
+#define LOG_MODULE LOG_DISPLAY
 
 #define DISPLAY_I2C_ADDR 0x70
 
-HT16K33 display;
+// HT16K33 single-byte commands
+#define HT16K33_OSCILLATOR_ON 0x21
+#define HT16K33_DISPLAY_ON 0x81 // Blinking off
+#define HT16K33_DIMMING 0xE0    // OR'd with the level, 0-15
+
+// Static member definitions
+uint8_t Display::desiredRam[Display::RAM_SIZE] = {0};
+uint8_t Display::messageRam[Display::RAM_SIZE] = {0};
+uint8_t Display::shownRam[Display::RAM_SIZE] = {0};
+bool Display::messageActive = false;
+unsigned long Display::messageStart = 0;
+uint32_t Display::messageDuration = 0;
+bool Display::shownValid = false;
+
+// Segment bits, named as on the SparkFun Qwiic Alphanumeric board:
+//
+//      ---A---
+//     |\  |  /|
+//     F H I J B
+//     |  \|/  |
+//      -G- -K-
+//     |  /|\  |
+//     E N M L C
+//     |/  |  \|
+//      ---D---
+enum Segment : uint16_t {
+    SEG_A = 1 << 0, SEG_B = 1 << 1, SEG_C = 1 << 2, SEG_D = 1 << 3,
+    SEG_E = 1 << 4, SEG_F = 1 << 5, SEG_G = 1 << 6, SEG_H = 1 << 7,
+    SEG_I = 1 << 8, SEG_J = 1 << 9, SEG_K = 1 << 10, SEG_L = 1 << 11,
+    SEG_M = 1 << 12, SEG_N = 1 << 13,
+};
+
+static const uint16_t DIGIT_SEGMENTS[10] = {
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,                 // 0
+    SEG_B | SEG_C,                                                 // 1
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G | SEG_K,                 // 2
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_G | SEG_K,                 // 3
+    SEG_B | SEG_C | SEG_F | SEG_G | SEG_K,                         // 4
+    SEG_A | SEG_C | SEG_D | SEG_F | SEG_G | SEG_K,                 // 5
+    SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G | SEG_K,         // 6
+    SEG_A | SEG_B | SEG_C,                                         // 7
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G | SEG_K, // 8
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G | SEG_K,         // 9
+};
+
+static const uint16_t LETTER_SEGMENTS[26] = {
+    SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G | SEG_K,         // A
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_I | SEG_M | SEG_K,         // B
+    SEG_A | SEG_D | SEG_E | SEG_F,                                 // C
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_I | SEG_M,                 // D
+    SEG_A | SEG_D | SEG_E | SEG_F | SEG_G,                         // E
+    SEG_A | SEG_E | SEG_F | SEG_G,                                 // F
+    SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_K,                 // G
+    SEG_B | SEG_C | SEG_E | SEG_F | SEG_G | SEG_K,                 // H
+    SEG_A | SEG_D | SEG_I | SEG_M,                                 // I
+    SEG_B | SEG_C | SEG_D | SEG_E,                                 // J
+    SEG_E | SEG_F | SEG_G | SEG_J | SEG_L,                         // K
+    SEG_D | SEG_E | SEG_F,                                         // L
+    SEG_B | SEG_C | SEG_E | SEG_F | SEG_H | SEG_J,                 // M
+    SEG_B | SEG_C | SEG_E | SEG_F | SEG_H | SEG_L,                 // N
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,                 // O
+    SEG_A | SEG_B | SEG_E | SEG_F | SEG_G | SEG_K,                 // P
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_L,         // Q
+    SEG_A | SEG_B | SEG_E | SEG_F | SEG_G | SEG_K | SEG_L,         // R
+    SEG_A | SEG_C | SEG_D | SEG_F | SEG_G | SEG_K,                 // S
+    SEG_A | SEG_I | SEG_M,                                         // T
+    SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,                         // U
+    SEG_E | SEG_F | SEG_J | SEG_N,                                 // V
+    SEG_B | SEG_C | SEG_E | SEG_F | SEG_L | SEG_N,                 // W
+    SEG_H | SEG_J | SEG_L | SEG_N,                                 // X
+    SEG_H | SEG_J | SEG_M,                                         // Y
+    SEG_A | SEG_D | SEG_J | SEG_N,                                 // Z
+};
 
 void Display::init() {
-  if (display.begin() == false)
+  if (!sendCommand(HT16K33_OSCILLATOR_ON, "display-setup") ||
+      !sendCommand(HT16K33_DISPLAY_ON, "display-setup"))
   {
-    Log::error("Device did not acknowledge! Freezing.");
+    LOG_ERROR("Device did not acknowledge! Freezing.");
     while(1);
   }
-  Log::info("Display acknowledged.");
+  LOG_INFO("Display acknowledged.");
 
   // Load saved brightness from settings
   uint8_t savedBrightness = Settings::getDisplayBrightness();
-  display.setBrightness(savedBrightness);
-}
+  sendCommand(HT16K33_DIMMING | savedBrightness, "display-dim");
 
-HT16K33& Display::getInstance() {
-    return display;
+  // Force the first flush to write the whole framebuffer
+  shownValid = false;
+  flush();
 }
 
 void Display::setBrightness(uint8_t brightness) {
     if (brightness > 15) brightness = 15; // Clamp to valid range
-    display.setBrightness(brightness);
+    sendCommand(HT16K33_DIMMING | brightness, "display-dim");
     Settings::setDisplayBrightness(brightness);
-}
\ No newline at end of file
+}
+
+uint16_t Display::segmentsFor(char c) {
+    if (c >= '0' && c <= '9') return DIGIT_SEGMENTS[c - '0'];
+    if (c >= 'A' && c <= 'Z') return LETTER_SEGMENTS[c - 'A'];
+    if (c >= 'a' && c <= 'z') return LETTER_SEGMENTS[c - 'a'];
+    if (c == '-') return SEG_G | SEG_K;
+    if (c == '%') return SEG_C | SEG_F | SEG_J | SEG_N;
+    return 0; // Space and anything we have no glyph for
+}
+
+// Map a digit's segments onto HT16K33 RAM the same way the SparkFun library
+// does: A-G use rows 0-3 of COM0-6, H-N use rows 4-7 (with H and I swapped).
+void Display::setDigit(uint8_t ram[RAM_SIZE], uint8_t digit, uint16_t segments) {
+    static const uint8_t COM_FOR_SEGMENT[14] = {0, 1, 2, 3, 4, 5, 6, 1, 0, 2, 3, 4, 5, 6};
+
+    for (uint8_t segment = 0; segment < 14; segment++) {
+        uint8_t row = digit + (segment > 6 ? 4 : 0);
+        uint8_t address = COM_FOR_SEGMENT[segment] * 2;
+        if (segments & (1 << segment)) {
+            ram[address] |= (1 << row);
+        } else {
+            ram[address] &= ~(1 << row);
+        }
+    }
+}
+
+void Display::render(uint8_t ram[RAM_SIZE], const char* text) {
+    uint8_t digit = 0;
+    for (; digit < DIGITS && text[digit] != '\0'; digit++) {
+        setDigit(ram, digit, segmentsFor(text[digit]));
+    }
+    for (; digit < DIGITS; digit++) {
+        setDigit(ram, digit, 0);
+    }
+}
+
+void Display::print(const char* text) {
+    render(desiredRam, text);
+}
+
+void Display::print(const DisplayText& text) {
+    print(text.c_str());
+}
+
+void Display::clear() {
+    memset(desiredRam, 0, sizeof(desiredRam));
+}
+
+void Display::setColon(bool on) {
+    if (on) {
+        desiredRam[COLON_ADDRESS] |= 0x01;
+    } else {
+        desiredRam[COLON_ADDRESS] &= ~0x01;
+    }
+}
+
+void Display::showMessage(const char* text, uint32_t durationMs) {
+    memset(messageRam, 0, sizeof(messageRam));
+    render(messageRam, text);
+    messageActive = true;
+    messageStart = millis();
+    messageDuration = durationMs;
+    Events::wakeAfter(durationMs);
+}
+
+void Display::cancelMessage() {
+    messageActive = false;
+}
+
+void Display::update() {
+    if (!messageActive) {
+        return;
+    }
+    unsigned long shownMs = millis() - messageStart;
+    if (shownMs >= messageDuration) {
+        messageActive = false;
+    } else {
+        // Woken early for something else; the earlier wake-up replaced ours
+        Events::wakeAfter(messageDuration - shownMs);
+    }
+}
+
+// Send the smallest contiguous run of RAM addresses covering every changed
+// byte; the HT16K33 auto-increments its address pointer.
+void Display::flush() {
+    const uint8_t* ram = messageActive ? messageRam : desiredRam;
+    int first = 0;
+    int last = RAM_SIZE - 1;
+    if (shownValid) {
+        while (first < RAM_SIZE && ram[first] == shownRam[first]) first++;
+        if (first == RAM_SIZE) {
+            return; // Nothing changed
+        }
+        while (ram[last] == shownRam[last]) last--;
+    }
+
+    uint8_t frame[1 + RAM_SIZE];
+    frame[0] = first; // Display data address pointer
+    memcpy(frame + 1, &ram[first], last - first + 1);
+    uint8_t error = Bus::write(DISPLAY_I2C_ADDR, frame, 1 + (last - first + 1), "display-flush");
+    if (error != 0) {
+        LOG_ERROR("Display write failed");
+        EventLog::record(EventLog::I2C_ERROR, DISPLAY_I2C_ADDR, error);
+        shownValid = false;
+        return;
+    }
+
+    memcpy(&shownRam[first], &ram[first], last - first + 1);
+    shownValid = true;
+}
+
+bool Display::sendCommand(uint8_t command, const char* site) {
+    return Bus::write(DISPLAY_I2C_ADDR, &command, 1, site) == 0;
+}
@@ -0,0 +1,91 @@
+#include "display_text.h"
+
+DisplayText::DisplayText() : length(0) {
+    buffer[0] = '\0';
+}
+
+DisplayText::DisplayText(const char* text) : DisplayText() {
+    append(text);
+}
+
+DisplayText& DisplayText::append(char c) {
+    if (length < CAPACITY) {
+        buffer[length++] = c;
+        buffer[length] = '\0';
+    }
+    return *this;
+}
+
+DisplayText& DisplayText::append(const char* text) {
+    while (*text != '\0') {
+        append(*text++);
+    }
+    return *this;
+}
+
+DisplayText& DisplayText::appendNumber(uint16_t value, uint8_t width, char pad) {
+    // Collect digits least significant first
+    char digits[5];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0 && count < sizeof(digits));
+
+    for (uint8_t i = count; i < width; i++) {
+        append(pad);
+    }
+    while (count > 0) {
+        append(digits[--count]);
+    }
+    return *this;
+}
+
+bool DisplayText::operator==(const DisplayText& other) const {
+    return length == other.length && memcmp(buffer, other.buffer, length) == 0;
+}
+
+DisplayText DisplayText::clockTime(uint8_t hours24, uint8_t minutes) {
+    // Convert to 12-hour format (00:xx becomes 12:xx, 13:xx becomes 1:xx)
+    uint8_t hours12 = hours24 % 12;
+    if (hours12 == 0) {
+        hours12 = 12;
+    }
+    DisplayText text;
+    text.appendNumber(hours12, 2, ' ').appendNumber(minutes, 2, '0');
+    return text;
+}
+
+DisplayText DisplayText::hourWithMeridiem(uint8_t hours24, char pad) {
+    uint8_t hours12 = hours24 % 12;
+    if (hours12 == 0) {
+        hours12 = 12;
+    }
+    DisplayText text;
+    text.appendNumber(hours12, 2, pad).append(hours24 < 12 ? "AM" : "PM");
+    return text;
+}
+
+DisplayText DisplayText::minutes(uint8_t minutes) {
+    DisplayText text("M ");
+    text.appendNumber(minutes, 2, '0');
+    return text;
+}
+
+DisplayText DisplayText::percent(uint8_t percent) {
+    DisplayText text;
+    text.appendNumber(percent, 3, ' ').append('%');
+    return text;
+}
+
+DisplayText DisplayText::level(uint8_t level) {
+    DisplayText text;
+    text.appendNumber(level, 2, '0');
+    return text;
+}
+
+DisplayText DisplayText::napMinutes(uint16_t minutes) {
+    DisplayText text;
+    text.appendNumber(minutes, 0, ' ');
+    return text;
+}
@@ -1,83 +1,209 @@
 #include "encoder.h"
+#include "events.h"
 #include "logging.h"
 
+#define LOG_MODULE LOG_INPUT
+
 #define DIAL_CLK_PIN 2
 #define DIAL_DT_PIN 3
 #define DIAL_SW_PIN 4
 
 ESP32Encoder encoder;
 
-volatile bool Encoder::buttonPressed;
-volatile unsigned long Encoder::lastButtonTime;
-volatile bool Encoder::lastButtonState;
-volatile bool Encoder::buttonStateStable;
-unsigned long Encoder::buttonPressStartTime = 0;
-bool Encoder::buttonHoldDetected = false;
-const unsigned long BUTTON_DEBOUNCE_MS = 50;
-const unsigned long BUTTON_HOLD_MS = 3000; // 3 seconds
+SpscRing<Encoder::InputEvent, Encoder::ROTATION_RING_SIZE> Encoder::rotationEvents;
+SpscRing<Encoder::InputEvent, Encoder::BUTTON_RING_SIZE> Encoder::buttonEvents;
+std::atomic<bool> Encoder::rotationPending(false);
+Encoder::ButtonRecognizer Encoder::button = {0, false, false, 0};
+esp_timer_handle_t Encoder::sampleTimer = nullptr;
+std::atomic<bool> Encoder::samplerRunning(false);
+std::atomic<uint32_t> Encoder::lastEdgeUs(0);
+int64_t Encoder::lastEncoderCount = 0;
+uint32_t Encoder::lastRotationUs = 0;
+uint32_t Encoder::latencyCount[Encoder::INPUT_EVENT_TYPES] = {0};
+uint64_t Encoder::latencyTotal[Encoder::INPUT_EVENT_TYPES] = {0};
+uint32_t Encoder::latencyMax[Encoder::INPUT_EVENT_TYPES] = {0};
+
+// The switch is sampled every BUTTON_SAMPLE_US while it is active; it counts
+// as changed after BUTTON_DEBOUNCE_SAMPLES agreeing samples (50 ms)
+const uint32_t BUTTON_SAMPLE_US = 5000;
+const uint8_t BUTTON_DEBOUNCE_SAMPLES = 10;
+const uint32_t BUTTON_HOLD_US = 3000000; // 3 seconds
+const unsigned long ROTATION_MIN_INTERVAL_MS = 10;
+const unsigned long ROTATION_IDLE_MS = 250; // A gap this long starts a new spin
+
+// Acceleration curve: spin speed (detents/s) at which each multiplier kicks in
+const uint16_t ACCEL_VELOCITY[] = {8, 16, 32};
+const int16_t ACCEL_MULTIPLIER[] = {2, 4, 8};
+
+static const char* const INPUT_EVENT_NAMES[] = {"rotate", "press", "hold"};
 
+// Edges only wake the sampler; all timing is decided in sampleButton()
 void IRAM_ATTR Encoder::buttonISR() {
-  lastButtonTime = millis();
+  lastEdgeUs.store((uint32_t)esp_timer_get_time(), std::memory_order_relaxed);
+  startSampler();
+}
+
+void IRAM_ATTR Encoder::startSampler() {
+  if (sampleTimer != nullptr && !samplerRunning.exchange(true)) {
+    esp_timer_start_periodic(sampleTimer, BUTTON_SAMPLE_US);
+  }
+}
+
+// PCNT does the counting; the ISR only marks the start of a burst
+void IRAM_ATTR Encoder::rotationISR() {
+  if (!rotationPending.exchange(true)) {
+    InputEvent input;
+    input.type = InputEvent::ROTATE;
+    input.timestampUs = (uint32_t)esp_timer_get_time();
+    if (!rotationEvents.push(input)) {
+      rotationPending.store(false);
+    }
+  }
+  Events::postFromISR(EVENT_ENCODER);
 }
 
 void Encoder::init() {
   encoder.attachSingleEdge(DIAL_DT_PIN, DIAL_CLK_PIN);
   encoder.setCount(0);
+  attachInterrupt(digitalPinToInterrupt(DIAL_CLK_PIN), rotationISR, CHANGE);
+
+  esp_timer_create_args_t timerArgs = {};
+  timerArgs.callback = sampleButton;
+  timerArgs.name = "button";
+  if (esp_timer_create(&timerArgs, &sampleTimer) != ESP_OK) {
+    LOG_ERROR("Failed to create button sample timer");
+    sampleTimer = nullptr;
+  }
 
   pinMode(DIAL_SW_PIN, INPUT_PULLUP);
+  // A button held through boot is treated as already pressed, not a press
+  button.pressed = (digitalRead(DIAL_SW_PIN) == LOW);
+  button.integrator = button.pressed ? BUTTON_DEBOUNCE_SAMPLES : 0;
+  button.holdFired = button.pressed;
   attachInterrupt(digitalPinToInterrupt(DIAL_SW_PIN), buttonISR, CHANGE);
+  if (button.pressed) {
+    startSampler();
+  }
+}
+
+void Encoder::emitButtonEvent(InputEvent::Type type, uint32_t timestampUs) {
+  InputEvent input;
+  input.type = type;
+  input.timestampUs = timestampUs;
+  buttonEvents.push(input);
+  Events::post(EVENT_BUTTON);
+}
+
+// Runs in the esp_timer task on a fixed period, so debounce and hold
+// timing do not depend on how busy loop() is
+void Encoder::sampleButton(void* arg) {
+  uint32_t nowUs = (uint32_t)esp_timer_get_time();
+  bool level = (digitalRead(DIAL_SW_PIN) == LOW);
+
+  if (level && button.integrator < BUTTON_DEBOUNCE_SAMPLES) {
+    button.integrator++;
+  } else if (!level && button.integrator > 0) {
+    button.integrator--;
+  }
+
+  if (!button.pressed && button.integrator == BUTTON_DEBOUNCE_SAMPLES) {
+    button.pressed = true;
+    button.holdFired = false;
+    button.pressStartUs = nowUs;
+    emitButtonEvent(InputEvent::PRESS, lastEdgeUs.load(std::memory_order_relaxed));
+  } else if (button.pressed && button.integrator == 0) {
+    button.pressed = false;
+  } else if (button.pressed && !button.holdFired && nowUs - button.pressStartUs >= BUTTON_HOLD_US) {
+    button.holdFired = true;
+    emitButtonEvent(InputEvent::HOLD, nowUs);
+  }
+
+  // Stop sampling once the switch has settled released. An edge racing
+  // with the stop is caught by re-reading the pin.
+  if (!button.pressed && button.integrator == 0) {
+    esp_timer_stop(sampleTimer);
+    samplerRunning.store(false);
+    if (digitalRead(DIAL_SW_PIN) == LOW) {
+      startSampler();
+    }
+  }
 }
 
-Action Encoder::getAction() {
-  static int64_t lastEncoderCount = 0;
+void Encoder::recordLatency(const InputEvent& input, uint32_t nowUs) {
+  uint32_t latency = nowUs - input.timestampUs;
+  latencyCount[input.type]++;
+  latencyTotal[input.type] += latency;
+  if (latency > latencyMax[input.type]) {
+    latencyMax[input.type] = latency;
+  }
+}
+
+ActionEvent Encoder::getAction() {
+  ActionEvent event = {NONE, 0, 0};
+  uint32_t nowUs = (uint32_t)esp_timer_get_time();
+
+  // Button events first: PRESS is SELECT, HOLD is SELECT_HOLD
+  InputEvent input;
+  if (buttonEvents.pop(input)) {
+    recordLatency(input, nowUs);
+    event.action = (input.type == InputEvent::HOLD) ? SELECT_HOLD : SELECT;
+    // Anything still queued goes out on the next pass
+    if (!buttonEvents.empty() || !rotationEvents.empty() || encoder.getCount() != lastEncoderCount) {
+      Events::post(EVENT_BUTTON);
+    }
+    return event;
+  }
+
+  uint32_t burstStartUs = nowUs;
+  while (rotationEvents.pop(input)) {
+    recordLatency(input, nowUs);
+    rotationPending.store(false);
+    burstStartUs = input.timestampUs;
+  }
+
+  // Consume every detent counted since the last call as one burst
   int64_t currentCount = encoder.getCount();
-  
-  Action action = NONE;
-  
-  // Check for rotation
-  if (currentCount > lastEncoderCount) {
-    action = CW;
-    lastEncoderCount = currentCount;
-  } else if (currentCount < lastEncoderCount) {
-    action = CCW;
+  int64_t delta = currentCount - lastEncoderCount;
+  if (delta != 0) {
+    if (delta > INT16_MAX) delta = INT16_MAX;
+    if (delta < -INT16_MAX) delta = -INT16_MAX;
     lastEncoderCount = currentCount;
+
+    unsigned long interval = (burstStartUs - lastRotationUs) / 1000;
+    lastRotationUs = burstStartUs;
+    if (interval > ROTATION_IDLE_MS) interval = ROTATION_IDLE_MS;
+    if (interval < ROTATION_MIN_INTERVAL_MS) interval = ROTATION_MIN_INTERVAL_MS;
+
+    uint32_t detents = (delta < 0) ? -delta : delta;
+    uint32_t velocity = detents * 1000 / interval;
+    event.action = (delta > 0) ? CW : CCW;
+    event.delta = (int16_t)delta;
+    event.velocity = (velocity > UINT16_MAX) ? UINT16_MAX : velocity;
   }
   
-  // Software debouncing for button
-  static unsigned long lastDebounceTime = 0;
-  bool currentButtonState = digitalRead(DIAL_SW_PIN);
-  
-  if (currentButtonState != lastButtonState) {
-    lastDebounceTime = millis();
-  }
-  
-  if ((millis() - lastDebounceTime) > BUTTON_DEBOUNCE_MS) {
-    if (currentButtonState != buttonStateStable) {
-      buttonStateStable = currentButtonState;
-      
-      // Button pressed (transition from HIGH to LOW)
-      if (buttonStateStable == LOW) {
-        buttonPressStartTime = millis();
-        buttonHoldDetected = false;
-        // Trigger SELECT immediately on button press
-        action = SELECT;
-      }
-      // Button released (transition from LOW to HIGH)
-      else if (buttonStateStable == HIGH) {
-        unsigned long pressDuration = millis() - buttonPressStartTime;
-        
-        // Trigger SELECT_HOLD on release if held for 3+ seconds
-        if (pressDuration >= BUTTON_HOLD_MS) {
-          action = SELECT_HOLD;
-        }
-        
-        buttonHoldDetected = false;
-        buttonPressStartTime = 0;
-      }
+  return event;
+}
+
+int16_t Encoder::accelerate(int16_t detents, uint16_t velocity) {
+  int16_t multiplier = 1;
+  for (size_t i = 0; i < sizeof(ACCEL_VELOCITY) / sizeof(ACCEL_VELOCITY[0]); i++) {
+    if (velocity >= ACCEL_VELOCITY[i]) {
+      multiplier = ACCEL_MULTIPLIER[i];
     }
   }
-  
-  lastButtonState = currentButtonState;
-  
-  return action;
-}
\ No newline at end of file
+  int32_t steps = (int32_t)detents * multiplier;
+  if (steps > INT16_MAX) steps = INT16_MAX;
+  if (steps < -INT16_MAX) steps = -INT16_MAX;
+  return (int16_t)steps;
+}
+
+void Encoder::logInputStats() {
+  for (uint8_t type = 0; type < INPUT_EVENT_TYPES; type++) {
+    [[maybe_unused]] uint32_t average = latencyCount[type] ? (uint32_t)(latencyTotal[type] / latencyCount[type]) : 0;
+    LOG_REPORT("Input %s: %lu events, ISR-to-handler latency avg %lu us, max %lu us",
+                INPUT_EVENT_NAMES[type], (unsigned long)latencyCount[type],
+                (unsigned long)average, (unsigned long)latencyMax[type]);
+  }
+  LOG_REPORT("Input rings: %lu rotation, %lu button events dropped",
+              (unsigned long)rotationEvents.getDropped(), (unsigned long)buttonEvents.getDropped());
+}
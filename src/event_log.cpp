@@ -0,0 +1,280 @@
+#include "event_log.h"
+#include "events.h"
+#include "logging.h"
+#include <algorithm>
+
+#define LOG_MODULE LOG_SYSTEM
+
+// Static member definitions
+I2cEeprom EventLog::eeprom(EventLog::I2C_ADDRESS, EventLog::DEVICE_SIZE, EventLog::PAGE_SIZE);
+bool EventLog::available = false;
+uint32_t EventLog::nextSequence = 0;
+uint16_t EventLog::headSlot = 0;
+EventLog::Record EventLog::queue[EventLog::QUEUE_SIZE];
+uint8_t EventLog::queueHead = 0;
+uint8_t EventLog::queueCount = 0;
+uint8_t EventLog::lastI2cAddress = 0;
+uint8_t EventLog::lastI2cError = 0;
+unsigned long EventLog::lastI2cErrorMs = 0;
+uint32_t EventLog::recordsWritten = 0;
+uint32_t EventLog::recordsDropped = 0;
+uint32_t EventLog::writeErrors = 0;
+uint32_t EventLog::errorsSuppressed = 0;
+
+static const char* const RESET_REASONS[] = {
+    "unknown", "power-on", "external", "software", "panic", "interrupt watchdog",
+    "task watchdog", "watchdog", "deep sleep", "brownout", "SDIO"
+};
+static const char* const BLOCK_NAMES[] = {"wind-down", "sleep", "quiet", "wake", "none"};
+
+namespace {
+
+void putUint32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+uint32_t getUint32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+// CRC-8 (polynomial 0x07); an erased slot of all 0xFF never checks out
+uint8_t crc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+const char* resetReasonName(uint8_t reason) {
+    return reason < sizeof(RESET_REASONS) / sizeof(RESET_REASONS[0]) ? RESET_REASONS[reason] : "?";
+}
+
+const char* blockName(uint8_t block) {
+    return block < sizeof(BLOCK_NAMES) / sizeof(BLOCK_NAMES[0]) ? BLOCK_NAMES[block] : "?";
+}
+
+} // namespace
+
+// Slots [0, head) hold the current lap, numbered on from slot 0's sequence;
+// anything past the head is the previous lap or blank. That split is found
+// with O(log n) reads. A torn last write just fails its CRC and is reused.
+bool EventLog::init() {
+    available = false;
+    queueHead = 0;
+    queueCount = 0;
+    uint8_t bytes[RECORD_SIZE];
+    if (!eeprom.begin() || !readSlot(0, bytes)) {
+        LOG_ERROR("Event log EEPROM not found at 0x%02x", I2C_ADDRESS);
+        return false;
+    }
+
+    Record first;
+    if (decode(bytes, first)) {
+        uint16_t low = 1;
+        uint16_t high = SLOT_COUNT;
+        while (low < high) {
+            uint16_t middle = low + (high - low) / 2;
+            bool ok;
+            bool inLap = isCurrentLap(middle, first.sequence, ok);
+            if (!ok) {
+                LOG_ERROR("Event log read failed during recovery");
+                return false;
+            }
+            if (inLap) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        headSlot = low % SLOT_COUNT;
+        nextSequence = first.sequence + low;
+    } else {
+        // Blank device, or the lap's first write was torn: carry on from the
+        // end of the previous lap if there is one
+        Record last;
+        headSlot = 0;
+        nextSequence = 0;
+        if (readSlot(SLOT_COUNT - 1, bytes) && decode(bytes, last)) {
+            nextSequence = last.sequence + 1;
+        }
+    }
+
+    available = true;
+    LOG_INFO("Event log: head at slot %u, next sequence %lu", headSlot, (unsigned long)nextSequence);
+    return true;
+}
+
+bool EventLog::isCurrentLap(uint16_t slot, uint32_t firstSequence, bool& ok) {
+    uint8_t bytes[RECORD_SIZE];
+    Record record;
+    ok = readSlot(slot, bytes);
+    return ok && decode(bytes, record) && record.sequence == firstSequence + slot;
+}
+
+void EventLog::record(Type type, uint8_t a, uint8_t b, uint32_t value) {
+    if (!available) {
+        return;
+    }
+    // A missing device fails on every poll; one record a minute is plenty
+    if (type == I2C_ERROR) {
+        if (a == lastI2cAddress && b == lastI2cError && lastI2cErrorMs != 0 &&
+            millis() - lastI2cErrorMs < I2C_ERROR_HOLDOFF_MS) {
+            errorsSuppressed++;
+            return;
+        }
+        lastI2cAddress = a;
+        lastI2cError = b;
+        lastI2cErrorMs = millis();
+    }
+    if (queueCount == QUEUE_SIZE) {
+        recordsDropped++;
+        return;
+    }
+
+    Record& record = queue[(queueHead + queueCount) % QUEUE_SIZE];
+    record.sequence = nextSequence++;
+    record.uptimeMs = millis();
+    record.type = type;
+    record.a = a;
+    record.b = b;
+    record.value = value;
+    queueCount++;
+}
+
+// Queued records that share a page go out as one page write. Records for
+// the next page wait for the following call, so the loop never sits out a
+// write cycle.
+void EventLog::update() {
+    if (queueCount == 0 && !eeprom.isDirty()) {
+        return;
+    }
+    if (eeprom.isBusy()) {
+        Events::wakeAfter(WRITE_CYCLE_MS);
+        return;
+    }
+
+    while (queueCount > 0) {
+        uint8_t bytes[RECORD_SIZE];
+        encode(queue[queueHead], bytes);
+        if (!eeprom.write((uint32_t)headSlot * RECORD_SIZE, bytes, RECORD_SIZE)) {
+            break;
+        }
+        headSlot = (headSlot + 1) % SLOT_COUNT;
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        queueCount--;
+        recordsWritten++;
+        if (headSlot % RECORDS_PER_PAGE == 0) {
+            break;
+        }
+    }
+
+    if (!eeprom.flush()) {
+        writeErrors++;
+        Events::wakeAfter(RETRY_MS);
+        return;
+    }
+    if (queueCount > 0) {
+        Events::wakeAfter(WRITE_CYCLE_MS);
+    }
+}
+
+void EventLog::dump(Print& out) {
+    if (!available) {
+        out.println("Event log unavailable");
+        return;
+    }
+
+    // The slot at the head is the oldest one still stored. Batches never run
+    // past the end of the device, so each is a single burst read.
+    uint8_t batch[DUMP_BATCH * RECORD_SIZE];
+    uint16_t shown = 0;
+    uint16_t slot = headSlot;
+    for (uint16_t remaining = SLOT_COUNT; remaining > 0;) {
+        uint16_t count = std::min<uint16_t>(remaining, std::min<uint16_t>(DUMP_BATCH, SLOT_COUNT - slot));
+        if (!eeprom.read((uint32_t)slot * RECORD_SIZE, batch, count * RECORD_SIZE)) {
+            out.printf("Read failed at slot %u\n", slot);
+            return;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            Record record;
+            if (decode(batch + i * RECORD_SIZE, record)) {
+                print(out, record);
+                shown++;
+            }
+        }
+        slot = (slot + count) % SLOT_COUNT;
+        remaining -= count;
+    }
+    out.printf("%u records stored, %u queued\n", shown, queueCount);
+}
+
+void EventLog::print(Print& out, const Record& record) {
+    out.printf("#%lu %lu.%03lus ", (unsigned long)record.sequence,
+               (unsigned long)(record.uptimeMs / 1000), (unsigned long)(record.uptimeMs % 1000));
+    switch (record.type) {
+        case BOOT:
+            out.printf("boot, reset reason %s\n", resetReasonName(record.a));
+            break;
+        case I2C_ERROR:
+            out.printf("I2C error at 0x%02x, code %u\n", record.a, record.b);
+            break;
+        case STATE_CHANGE:
+            out.printf("state %u -> %u\n", record.a, record.b);
+            break;
+        case SCHEDULE_CHANGE:
+            out.printf("schedule %s -> %s at minute %lu of the week\n",
+                       blockName(record.a), blockName(record.b),
+                       (unsigned long)record.value);
+            break;
+        case SETTINGS_WRITE:
+            out.printf("settings image %lu written to slot %u\n", (unsigned long)record.value, record.a);
+            break;
+        default:
+            out.printf("unknown type %u\n", record.type);
+            break;
+    }
+}
+
+bool EventLog::readSlot(uint16_t slot, uint8_t bytes[RECORD_SIZE]) {
+    return eeprom.read((uint32_t)slot * RECORD_SIZE, bytes, RECORD_SIZE);
+}
+
+void EventLog::encode(const Record& record, uint8_t bytes[RECORD_SIZE]) {
+    putUint32(bytes, record.sequence);
+    putUint32(bytes + 4, record.uptimeMs);
+    bytes[8] = record.type;
+    bytes[9] = record.a;
+    bytes[10] = record.b;
+    putUint32(bytes + 11, record.value);
+    bytes[15] = crc8(bytes, RECORD_SIZE - 1);
+}
+
+bool EventLog::decode(const uint8_t bytes[RECORD_SIZE], Record& record) {
+    if (crc8(bytes, RECORD_SIZE - 1) != bytes[15]) {
+        return false;
+    }
+    record.sequence = getUint32(bytes);
+    record.uptimeMs = getUint32(bytes + 4);
+    record.type = bytes[8];
+    record.a = bytes[9];
+    record.b = bytes[10];
+    record.value = getUint32(bytes + 11);
+    return record.type != 0;
+}
+
+void EventLog::logStats() {
+    LOG_REPORT("Event log: %lu records written, %lu dropped, %lu write errors, %lu repeated I2C errors skipped",
+                (unsigned long)recordsWritten, (unsigned long)recordsDropped,
+                (unsigned long)writeErrors, (unsigned long)errorsSuppressed);
+    eeprom.logStats("Event log EEPROM");
+}
@@ -0,0 +1,119 @@
+#include "events.h"
+#include "logging.h"
+
+#define LOG_MODULE LOG_SYSTEM
+
+// Static member definitions
+TaskHandle_t Events::loopTask = nullptr;
+esp_timer_handle_t Events::wakeTimer = nullptr;
+portMUX_TYPE Events::timeLock = portMUX_INITIALIZER_UNLOCKED;
+int64_t Events::wakeDeadline = 0;
+int64_t Events::pendingSince = 0;
+uint32_t Events::wakeCount = 0;
+uint64_t Events::totalLatency = 0;
+uint32_t Events::maxLatency = 0;
+
+// Events are delivered as direct-to-task notification bits, which is the
+// cheapest ISR-to-task wakeup FreeRTOS offers.
+void Events::init() {
+    loopTask = xTaskGetCurrentTaskHandle();
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = wakeTimerCallback;
+    timerArgs.name = "loop_wake";
+    if (esp_timer_create(&timerArgs, &wakeTimer) != ESP_OK) {
+        LOG_ERROR("Failed to create loop wake timer");
+    }
+
+    LOG_INFO("Event loop initialized");
+}
+
+// Called from tasks and ISRs alike
+void IRAM_ATTR Events::markPending() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_SAFE(&timeLock);
+    if (pendingSince == 0) {
+        pendingSince = now;
+    }
+    portEXIT_CRITICAL_SAFE(&timeLock);
+}
+
+void Events::post(uint32_t bits) {
+    if (loopTask == nullptr) {
+        return;
+    }
+    markPending();
+    xTaskNotify(loopTask, bits, eSetBits);
+}
+
+void IRAM_ATTR Events::postFromISR(uint32_t bits) {
+    if (loopTask == nullptr) {
+        return;
+    }
+    markPending();
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xTaskNotifyFromISR(loopTask, bits, eSetBits, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+uint32_t Events::wait() {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+    portENTER_CRITICAL(&timeLock);
+    int64_t since = pendingSince;
+    pendingSince = 0;
+    portEXIT_CRITICAL(&timeLock);
+    if (since != 0) {
+        uint32_t latency = (uint32_t)(esp_timer_get_time() - since);
+        wakeCount++;
+        totalLatency += latency;
+        if (latency > maxLatency) {
+            maxLatency = latency;
+        }
+    }
+    return bits;
+}
+
+void Events::wakeAfter(uint32_t ms) {
+    if (wakeTimer == nullptr) {
+        return;
+    }
+    // Keep whichever pending wake-up is earliest. Callers with a later
+    // deadline must ask again when they are woken early.
+    int64_t deadline = esp_timer_get_time() + (int64_t)ms * 1000;
+    portENTER_CRITICAL(&timeLock);
+    bool earlier = (wakeDeadline == 0 || deadline < wakeDeadline);
+    if (earlier) {
+        wakeDeadline = deadline;
+    }
+    portEXIT_CRITICAL(&timeLock);
+    if (earlier) {
+        esp_timer_stop(wakeTimer);
+        esp_timer_start_once(wakeTimer, (uint64_t)ms * 1000);
+    }
+}
+
+void Events::wakeTimerCallback(void* arg) {
+    // A deadline still ahead was set after this expiry and has a timer of its own
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&timeLock);
+    if (wakeDeadline <= now) {
+        wakeDeadline = 0;
+    }
+    portEXIT_CRITICAL(&timeLock);
+    post(EVENT_TIMER);
+}
+
+uint32_t Events::getAverageLatencyMicros() {
+    return wakeCount == 0 ? 0 : (uint32_t)(totalLatency / wakeCount);
+}
+
+void Events::logLatencyStats() {
+    LOG_REPORT("Loop wakeups: %lu, latency avg %lu us, max %lu us",
+                (unsigned long)wakeCount,
+                (unsigned long)getAverageLatencyMicros(),
+                (unsigned long)maxLatency);
+}
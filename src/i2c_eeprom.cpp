@@ -0,0 +1,235 @@
+#include "i2c_eeprom.h"
+#include "logging.h"
+#include <algorithm>
+#include <cstring>
+
+#define LOG_MODULE LOG_SYSTEM
+
+I2cEeprom::I2cEeprom(uint8_t deviceAddress, uint32_t size, uint16_t pageSize)
+    : deviceAddress(deviceAddress),
+      deviceSize(size),
+      pageSize(pageSize > MAX_PAGE_SIZE ? MAX_PAGE_SIZE : pageSize),
+      pendingPage(-1),
+      dirtyStart(0),
+      dirtyEnd(0),
+      writeCycleRunning(false),
+      writeStartMicros(0),
+      cache(),
+      nextVictim(0),
+      stats() {}
+
+// Nothing buffered or cached survives a restart of the device
+bool I2cEeprom::begin() {
+    pendingPage = -1;
+    writeCycleRunning = false;
+    invalidateCache();
+    stats.busBytes += 1;
+    return Bus::probe(deviceAddress, "eeprom-probe") == 0;
+}
+
+bool I2cEeprom::read(uint32_t address, uint8_t* data, size_t length) {
+    if (address + length > deviceSize) {
+        return false;
+    }
+    // Scans would only thrash the cache, so they bypass it
+    if (length > LINE_SIZE) {
+        return readBus(address, data, length);
+    }
+
+    size_t done = 0;
+    while (done < length) {
+        uint32_t lineAddress = (address + done) & ~(uint32_t)(LINE_SIZE - 1);
+        CacheLine* line = lookup(lineAddress);
+        if (line != nullptr) {
+            stats.cacheHits++;
+        } else {
+            stats.cacheMisses++;
+            line = &cache[nextVictim];
+            nextVictim = (nextVictim + 1) % CACHE_LINES;
+            line->valid = false;
+            if (!readBus(lineAddress, line->data, LINE_SIZE)) {
+                return false;
+            }
+            line->address = lineAddress;
+            line->valid = true;
+        }
+        size_t offset = address + done - lineAddress;
+        size_t count = std::min((size_t)LINE_SIZE - offset, length - done);
+        memcpy(data + done, line->data + offset, count);
+        done += count;
+    }
+    return true;
+}
+
+bool I2cEeprom::write(uint32_t address, const uint8_t* data, size_t length) {
+    if (address + length > deviceSize) {
+        return false;
+    }
+    stats.logicalWrites++;
+    stats.bytesWritten += length;
+
+    while (length > 0) {
+        uint32_t pageAddress = address - address % pageSize;
+        uint16_t offset = address - pageAddress;
+        uint16_t count = std::min((size_t)(pageSize - offset), length);
+
+        // Only one contiguous run per page goes out in a single page write
+        if (pendingPage >= 0 && ((uint32_t)pendingPage != pageAddress ||
+                                 offset > dirtyEnd || offset + count < dirtyStart)) {
+            if (!flush()) {
+                return false;
+            }
+        }
+        if (pendingPage < 0) {
+            pendingPage = pageAddress;
+            dirtyStart = offset;
+            dirtyEnd = offset + count;
+        } else {
+            dirtyStart = std::min(dirtyStart, offset);
+            dirtyEnd = std::max(dirtyEnd, (uint16_t)(offset + count));
+        }
+        memcpy(page + offset, data, count);
+        updateCache(address, data, count);
+
+        address += count;
+        data += count;
+        length -= count;
+    }
+    return true;
+}
+
+bool I2cEeprom::flush() {
+    if (pendingPage < 0) {
+        return true;
+    }
+    waitReady();
+
+    uint32_t address = pendingPage + dirtyStart;
+    uint16_t count = dirtyEnd - dirtyStart;
+    uint8_t frame[2 + MAX_PAGE_SIZE];
+    frame[0] = address >> 8;
+    frame[1] = address & 0xFF;
+    memcpy(frame + 2, page + dirtyStart, count);
+    uint8_t error = Bus::write(deviceAddress, frame, 2 + count, "eeprom-write");
+    stats.busBytes += 3 + count;
+    if (error != 0) {
+        // Left pending for the next flush; the cache may be ahead of the device
+        stats.errors++;
+        invalidateCache();
+        LOG_ERROR("EEPROM 0x%02x page write at 0x%04lx failed (%u)", deviceAddress,
+                  (unsigned long)address, error);
+        return false;
+    }
+
+    stats.writeCycles++;
+    writeCycleRunning = true;
+    writeStartMicros = micros();
+    pendingPage = -1;
+    return true;
+}
+
+bool I2cEeprom::isBusy() {
+    if (!writeCycleRunning) {
+        return false;
+    }
+    if (micros() - writeStartMicros < WRITE_CYCLE_TIMEOUT_US) {
+        stats.ackPolls++;
+        stats.busBytes += 1;
+        if (Bus::probe(deviceAddress, "eeprom-poll") != 0) {
+            return true;
+        }
+    }
+    writeCycleRunning = false;
+    return false;
+}
+
+// The device ignores its address until the write cycle is over, so poll
+// for the ACK instead of sleeping for the worst case
+void I2cEeprom::waitReady() {
+    if (!writeCycleRunning) {
+        return;
+    }
+    uint32_t start = micros();
+    while (isBusy()) {
+    }
+    uint32_t waited = micros() - start;
+    if (waited > stats.maxWaitMicros) {
+        stats.maxWaitMicros = waited;
+    }
+}
+
+bool I2cEeprom::readBus(uint32_t address, uint8_t* data, size_t length) {
+    waitReady();
+    while (length > 0) {
+        size_t chunk = std::min(length, (size_t)MAX_BURST);
+        uint8_t command[2] = {(uint8_t)(address >> 8), (uint8_t)(address & 0xFF)};
+        if (Bus::read(deviceAddress, command, sizeof(command), data, chunk, "eeprom-read") != 0) {
+            stats.errors++;
+            return false;
+        }
+        stats.busBytes += 4 + chunk; // Write address, two address bytes, read address
+        if (chunk > LINE_SIZE) {
+            stats.burstReads++;
+        }
+        overlayPending(address, data, chunk);
+
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+// Bytes still in the page buffer are newer than what the device holds
+void I2cEeprom::overlayPending(uint32_t address, uint8_t* data, size_t length) const {
+    if (pendingPage < 0) {
+        return;
+    }
+    uint32_t start = std::max(address, (uint32_t)pendingPage + dirtyStart);
+    uint32_t end = std::min(address + (uint32_t)length, (uint32_t)pendingPage + dirtyEnd);
+    if (start < end) {
+        memcpy(data + (start - address), page + (start - pendingPage), end - start);
+    }
+}
+
+void I2cEeprom::updateCache(uint32_t address, const uint8_t* data, size_t length) {
+    for (CacheLine& line : cache) {
+        if (!line.valid) {
+            continue;
+        }
+        uint32_t start = std::max(address, line.address);
+        uint32_t end = std::min(address + (uint32_t)length, line.address + LINE_SIZE);
+        if (start < end) {
+            memcpy(line.data + (start - line.address), data + (start - address), end - start);
+        }
+    }
+}
+
+void I2cEeprom::invalidateCache() {
+    for (CacheLine& line : cache) {
+        line.valid = false;
+    }
+}
+
+I2cEeprom::CacheLine* I2cEeprom::lookup(uint32_t lineAddress) {
+    for (CacheLine& line : cache) {
+        if (line.valid && line.address == lineAddress) {
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+void I2cEeprom::logStats(const char* name) const {
+    // Write cycles per logical write, with one decimal; below 1 means writes were combined
+    [[maybe_unused]] uint32_t cyclesPerWrite10 = stats.logicalWrites ? stats.writeCycles * 10 / stats.logicalWrites : 0;
+    LOG_REPORT("%s: %lu writes (%lu bytes) in %lu write cycles (%lu.%lu per write), %lu ACK polls, max wait %lu us",
+                name, (unsigned long)stats.logicalWrites, (unsigned long)stats.bytesWritten,
+                (unsigned long)stats.writeCycles, (unsigned long)(cyclesPerWrite10 / 10),
+                (unsigned long)(cyclesPerWrite10 % 10), (unsigned long)stats.ackPolls,
+                (unsigned long)stats.maxWaitMicros);
+    LOG_REPORT("%s: cache %lu hits, %lu misses, %lu burst reads, %lu bytes on bus, %lu errors",
+                name, (unsigned long)stats.cacheHits, (unsigned long)stats.cacheMisses,
+                (unsigned long)stats.burstReads, (unsigned long)stats.busBytes,
+                (unsigned long)stats.errors);
+}
@@ -1,145 +1,590 @@
 #include "logging.h"
 #include <Elog.h>
 #include <logging.h>
+#include <string.h>
+
+#define LOG_MODULE LOG_SYSTEM
+
+#define LOG_TASK_STACK 4096
+#define LOG_TASK_PRIORITY 1
+#define LOG_TASK_CORE 0 // Away from the core running loop()
+
+#define DEFAULT_RATE_WINDOW_MS 3600000 // 1 hour
+#define DEFAULT_RATE_BURST 3
+#define DEFAULT_REPEAT_WINDOW_MS 5000
+
+static const char* const LEVEL_NAMES[] = {"ERROR", "WARN", "NOTICE", "INFO", "DEBUG"};
+static const char* const MODULE_NAMES[] = {"system", "clock", "settings", "input", "display", "led"};
+
+// Binary frames: SYNC, kind, payload length, payload, checksum (sum of kind,
+// length and payload bytes). tools/log_decode.py must match this layout.
+static const uint8_t FRAME_SYNC = 0xA5;
+static const uint8_t FRAME_TRUNCATED = 0x80; // Set in the level byte
+static const uint8_t MAX_STRING_ARG = 48;
+static const uint8_t MAX_DEFINITION_LENGTH = 250;
+
+namespace {
+
+class ArgWriter {
+public:
+    ArgWriter(uint8_t* out, uint8_t capacity) : out(out), capacity(capacity), used(0), full(false) {}
+
+    void put(const void* data, uint8_t length) {
+        if (full || used + length > capacity) {
+            full = true;
+            return;
+        }
+        memcpy(out + used, data, length);
+        used += length;
+    }
+
+    void putU32(uint32_t value) { put(&value, sizeof(value)); } // Little-endian on the ESP32
+    void putU64(uint64_t value) { put(&value, sizeof(value)); }
+
+    uint8_t size() const { return used; }
+    bool overflowed() const { return full; }
+
+private:
+    uint8_t* out;
+    uint8_t capacity;
+    uint8_t used;
+    bool full;
+};
+
+// Copy each argument's raw bytes in the order the conversions appear in
+// format: integers as 4 bytes (8 with ll/j), floating point as a 4-byte
+// float, strings as a length byte plus up to MAX_STRING_ARG bytes, and '*'
+// widths/precisions as 4 bytes.
+uint8_t encodeArgs(const char* format, va_list args, uint8_t* out, uint8_t capacity, bool& truncated) {
+    ArgWriter writer(out, capacity);
+    for (const char* p = format; *p != '\0' && !writer.overflowed(); p++) {
+        if (*p != '%') continue;
+        p++;
+        if (*p == '%') continue;
+
+        while (*p != '\0' && strchr("-+ #0", *p)) p++;
+        if (*p == '*') {
+            writer.putU32((uint32_t)va_arg(args, int));
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                writer.putU32((uint32_t)va_arg(args, int));
+                p++;
+            }
+            while (*p >= '0' && *p <= '9') p++;
+        }
+
+        int longs = 0;
+        while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L') {
+            if (*p == 'l') longs++;
+            if (*p == 'j') longs = 2;
+            p++;
+        }
+
+        switch (*p) {
+            case 'd': case 'i':
+            case 'u': case 'x': case 'X': case 'o': case 'c':
+                if (longs >= 2) {
+                    writer.putU64((uint64_t)va_arg(args, long long));
+                } else if (longs == 1) {
+                    writer.putU32((uint32_t)va_arg(args, long));
+                } else {
+                    writer.putU32((uint32_t)va_arg(args, int));
+                }
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                float value = (float)va_arg(args, double);
+                writer.put(&value, sizeof(value));
+                break;
+            }
+            case 's': {
+                const char* text = va_arg(args, const char*);
+                if (text == nullptr) text = "(null)";
+                size_t length = strnlen(text, MAX_STRING_ARG);
+                uint8_t lengthByte = (uint8_t)length;
+                writer.put(&lengthByte, 1);
+                writer.put(text, lengthByte);
+                break;
+            }
+            case 'p':
+                writer.putU32((uint32_t)(uintptr_t)va_arg(args, void*));
+                break;
+            default:
+                // Unknown conversion: the decoder cannot follow past it either
+                truncated = true;
+                return writer.size();
+        }
+        if (*p == '\0') break;
+    }
+    truncated = writer.overflowed();
+    return writer.size();
+}
+
+} // namespace
 
 // Static member definitions
+uint8_t Log::moduleLevels[LOG_MODULE_COUNT] = {
+    LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO
+};
 bool Log::useElog = true;
 bool Log::initialized = false;
+Log::OverflowPolicy Log::overflowPolicy = Log::OverflowPolicy::DROP;
+Log::Record Log::ring[Log::RING_SIZE];
+std::atomic<uint32_t> Log::enqueuePos(0);
+std::atomic<uint32_t> Log::dequeuePos(0);
+std::atomic<uint32_t> Log::writtenCount(0);
+std::atomic<uint32_t> Log::droppedCount(0);
+std::atomic<uint32_t> Log::peakDepth(0);
+TaskHandle_t Log::drainTask = nullptr;
+std::atomic<bool> Log::binaryMode(false);
+const char* Log::formats[Log::FORMAT_SLOTS] = {nullptr};
+bool Log::announced[Log::FORMAT_SLOTS] = {false};
+portMUX_TYPE Log::formatLock = portMUX_INITIALIZER_UNLOCKED;
+uint32_t Log::rateWindowMs = DEFAULT_RATE_WINDOW_MS;
+uint16_t Log::rateBurst = DEFAULT_RATE_BURST;
+uint32_t Log::repeatWindowMs = DEFAULT_REPEAT_WINDOW_MS;
+Log::Site* Log::sites = nullptr;
+portMUX_TYPE Log::siteLock = portMUX_INITIALIZER_UNLOCKED;
+std::atomic<uint32_t> Log::rateLimitedCount(0);
+uint32_t Log::collapsedCount = 0;
+Log::Previous Log::previous = {};
 
 void Log::init(bool useElogFlag) {
     useElog = useElogFlag;
     
     if (useElog) {
-        // Initialize Elog with conservative settings
-        Logger.configure(500, true);  // Large buffer, blocking mode
+        // Only the drain task talks to Elog, so it may run non-blocking
+        Logger.configure(500, false);
         delay(100);
         Logger.registerSerial(MAIN_LOG, ELOG_LEVEL_INFO, "LOG", Serial);
         delay(100);
     }
+
+    for (uint16_t i = 0; i < RING_SIZE; i++) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    if (xTaskCreatePinnedToCore(drainLoop, "log", LOG_TASK_STACK, nullptr,
+                                LOG_TASK_PRIORITY, &drainTask, LOG_TASK_CORE) != pdPASS) {
+        // Keep logging, just synchronously
+        drainTask = nullptr;
+    }
     
     initialized = true;
     
     if (useElog) {
-        Logger.info(MAIN_LOG, "Log module initialized with Elog");
+        LOG_INFO("Log module initialized with Elog");
     } else {
-        Serial.println("[LOG] Log module initialized with Serial fallback");
-        Serial.flush();
+        LOG_INFO("Log module initialized with Serial fallback");
+    }
+    if (drainTask == nullptr) {
+        LOG_ERROR("Failed to start log task, logging synchronously");
     }
 }
 
 void Log::setUseElog(bool enable) {
     useElog = enable;
     if (initialized) {
-        if (useElog) {
-            Serial.println("[LOG] Switched to Elog mode");
-        } else {
-            Serial.println("[LOG] Switched to Serial fallback mode");
+        LOG_INFO("Switched to %s mode", useElog ? "Elog" : "Serial fallback");
+    }
+}
+
+void Log::setOverflowPolicy(OverflowPolicy policy) {
+    overflowPolicy = policy;
+}
+
+void Log::setBinaryMode(bool enable) {
+    if (enable) {
+        // A decoder may have just attached, so send every definition again
+        portENTER_CRITICAL(&formatLock);
+        memset(announced, 0, sizeof(announced));
+        portEXIT_CRITICAL(&formatLock);
+    }
+    binaryMode.store(enable, std::memory_order_relaxed);
+}
+
+void Log::setModuleLevel(LogModule module, uint8_t level) {
+    if (module < LOG_MODULE_COUNT) {
+        moduleLevels[module] = (level > LOG_LEVEL_DEBUG) ? LOG_LEVEL_DEBUG : level;
+    }
+}
+
+uint8_t Log::getModuleLevel(LogModule module) {
+    return (module < LOG_MODULE_COUNT) ? moduleLevels[module] : LOG_LEVEL_NONE;
+}
+
+const char* Log::getModuleName(LogModule module) {
+    return (module < LOG_MODULE_COUNT) ? MODULE_NAMES[module] : "?";
+}
+
+void Log::setRateLimit(uint32_t windowMs, uint16_t burst) {
+    rateWindowMs = windowMs;
+    rateBurst = burst;
+}
+
+void Log::setRepeatWindow(uint32_t windowMs) {
+    repeatWindowMs = windowMs;
+}
+
+// Decide whether a call site may log now. When a site's window ends with
+// messages held back, one summary line is written before the next message.
+bool Log::admit(Site& site, uint8_t level, const char* format) {
+    if (!site.registered) {
+        portENTER_CRITICAL(&siteLock);
+        if (!site.registered) {
+            site.format = format;
+            site.next = sites;
+            sites = &site;
+            site.registered = true;
         }
-        Serial.flush();
+        portEXIT_CRITICAL(&siteLock);
     }
+    // Errors and warnings always get through; identical ones still collapse
+    if (rateBurst == 0 || level <= LOG_LEVEL_WARNING) {
+        return true;
+    }
+
+    uint32_t now = millis();
+    if (site.inWindow == 0 || now - site.windowStart >= rateWindowMs) {
+        uint32_t suppressed = site.suppressed;
+        site.windowStart = now;
+        site.inWindow = 0;
+        site.suppressed = 0;
+        if (suppressed > 0) {
+            write(level, "Suppressed %lu messages like \"%.48s\"", (unsigned long)suppressed, format);
+        }
+    }
+    if (site.inWindow < rateBurst) {
+        site.inWindow++;
+        return true;
+    }
+    site.suppressed++;
+    site.totalSuppressed++;
+    rateLimitedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
-void Log::info(const char* format, ...) {
+void Log::write(uint8_t level, const char* format, ...) {
+    if (level < LOG_LEVEL_ERROR || level > LOG_LEVEL_DEBUG) {
+        return;
+    }
     va_list args;
     va_start(args, format);
-    
-    if (useElog && initialized) {
-        logWithElog(ELOG_LEVEL_INFO, format, args);
-    } else {
-        logWithSerial("INFO", format, args);
-    }
-    
+    logMessage(static_cast<Level>(level - LOG_LEVEL_ERROR), format, args);
     va_end(args);
 }
 
-void Log::error(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    
-    if (useElog && initialized) {
-        logWithElog(ELOG_LEVEL_ERROR, format, args);
-    } else {
-        logWithSerial("ERROR", format, args);
+// Claim the next free slot, or return nullptr if the ring is full
+Log::Record* Log::claim(uint32_t& position) {
+    position = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Record& record = ring[position & (RING_SIZE - 1)];
+        uint32_t sequence = record.sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - position);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &record;
+            }
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            position = enqueuePos.load(std::memory_order_relaxed);
+        }
     }
-    
-    va_end(args);
 }
 
-void Log::warning(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    
-    if (useElog && initialized) {
-        logWithElog(ELOG_LEVEL_WARNING, format, args);
+// Claim a slot, applying the overflow policy. Drops are counted here.
+Log::Record* Log::claimSlot(uint32_t& position) {
+    Record* record = claim(position);
+    while (record == nullptr && overflowPolicy == OverflowPolicy::BLOCK &&
+           xTaskGetCurrentTaskHandle() != drainTask) {
+        vTaskDelay(1);
+        record = claim(position);
+    }
+    if (record == nullptr) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return record;
+}
+
+void Log::publish(Record* record, uint32_t position) {
+    record->sequence.store(position + 1, std::memory_order_release);
+
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+    uint32_t depth = position + 1 - dequeuePos.load(std::memory_order_relaxed);
+    uint32_t peak = peakDepth.load(std::memory_order_relaxed);
+    while (depth > peak && !peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+    xTaskNotifyGive(drainTask);
+}
+
+void Log::logMessage(Level level, const char* format, va_list args) {
+    uint32_t timestamp = millis();
+
+    if (drainTask == nullptr) {
+        // Before init (or without a drain task) write straight through
+        char buffer[TEXT_SIZE];
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        output(level, timestamp, buffer);
+        return;
+    }
+
+    if (binaryMode.load(std::memory_order_relaxed)) {
+        va_list binaryArgs;
+        va_copy(binaryArgs, args);
+        bool handled = logBinary(level, timestamp, format, binaryArgs);
+        va_end(binaryArgs);
+        if (handled) {
+            return;
+        }
+    }
+
+    uint32_t position;
+    Record* record = claimSlot(position);
+    if (record == nullptr) {
+        return;
+    }
+    record->timestamp = timestamp;
+    record->level = level;
+    record->kind = KIND_TEXT;
+    vsnprintf(record->text, sizeof(record->text), format, args);
+    publish(record, position);
+}
+
+// Find or assign the one-byte ID for a format string, keyed by its address.
+// needsDefinition is set for the caller that should announce a new ID.
+// Returns -1 if the table is full.
+int Log::lookupFormat(const char* format, bool& needsDefinition) {
+    uint32_t hash = (uint32_t)((uintptr_t)format >> 2) * 2654435761u;
+    uint16_t start = hash >> 24;
+    int id = -1;
+    needsDefinition = false;
+
+    portENTER_CRITICAL(&formatLock);
+    for (uint16_t i = 0; i < FORMAT_SLOTS; i++) {
+        uint16_t slot = (start + i) & (FORMAT_SLOTS - 1);
+        if (formats[slot] == nullptr) {
+            formats[slot] = format;
+        }
+        if (formats[slot] == format) {
+            id = slot;
+            needsDefinition = !announced[slot];
+            announced[slot] = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&formatLock);
+    return id;
+}
+
+// Queue the raw arguments instead of text; formatting happens on the host.
+// Returns false only if the format table is full and text should be used.
+bool Log::logBinary(Level level, uint32_t timestamp, const char* format, va_list args) {
+    bool needsDefinition;
+    int id = lookupFormat(format, needsDefinition);
+    if (id < 0) {
+        return false;
+    }
+
+    uint32_t position;
+    if (needsDefinition) {
+        Record* definition = claimSlot(position);
+        if (definition == nullptr) {
+            // Try again on the next use of this format
+            portENTER_CRITICAL(&formatLock);
+            announced[id] = false;
+            portEXIT_CRITICAL(&formatLock);
+        } else {
+            definition->kind = KIND_DEFINITION;
+            definition->formatId = id;
+            definition->format = format;
+            publish(definition, position);
+        }
+    }
+
+    Record* record = claimSlot(position);
+    if (record == nullptr) {
+        return true;
+    }
+    record->timestamp = timestamp;
+    record->level = level;
+    record->kind = KIND_MESSAGE;
+    record->formatId = id;
+    bool truncated = false;
+    record->length = encodeArgs(format, args, (uint8_t*)record->text, TEXT_SIZE, truncated);
+    record->truncated = truncated;
+    publish(record, position);
+    return true;
+}
+
+// Drain published records in order. A slot still being written stops the
+// pass; its producer notifies again once it is published. While a repeat
+// count is pending the task also wakes to flush it once the window passes.
+void Log::drainLoop(void* arg) {
+    for (;;) {
+        TickType_t timeout = previous.repeats > 0 ? pdMS_TO_TICKS(repeatWindowMs) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, timeout);
+
+        uint32_t position = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Record& record = ring[position & (RING_SIZE - 1)];
+            if (record.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            drainRecord(record);
+            record.sequence.store(position + RING_SIZE, std::memory_order_release);
+            position++;
+            dequeuePos.store(position, std::memory_order_relaxed);
+        }
+
+        if (previous.repeats > 0 && millis() - previous.timestamp >= repeatWindowMs) {
+            flushRepeats();
+        }
+    }
+}
+
+void Log::drainRecord(const Record& record) {
+    if (isRepeat(record)) {
+        previous.repeats++;
+        previous.timestamp = record.timestamp;
+        collapsedCount++;
+        return;
+    }
+    flushRepeats();
+
+    if (record.kind == KIND_TEXT) {
+        output(record.level, record.timestamp, record.text);
     } else {
-        logWithSerial("WARN", format, args);
+        writeFrame(record);
+    }
+
+    // Definitions are not messages; they must not break a run of repeats
+    if (record.kind != KIND_DEFINITION) {
+        previous.valid = true;
+        previous.kind = record.kind;
+        previous.level = record.level;
+        previous.formatId = record.formatId;
+        previous.timestamp = record.timestamp;
+        if (record.kind == KIND_TEXT) {
+            memcpy(previous.text, record.text, sizeof(previous.text));
+        } else {
+            previous.length = record.length;
+            memcpy(previous.text, record.text, record.length);
+        }
     }
-    
-    va_end(args);
 }
 
-void Log::debug(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    
-    if (useElog && initialized) {
-        logWithElog(ELOG_LEVEL_DEBUG, format, args);
+bool Log::isRepeat(const Record& record) {
+    if (!previous.valid || record.kind != previous.kind || record.level != previous.level ||
+        record.timestamp - previous.timestamp > repeatWindowMs) {
+        return false;
+    }
+    if (record.kind == KIND_TEXT) {
+        return strcmp(record.text, previous.text) == 0;
+    }
+    return record.kind == KIND_MESSAGE && record.formatId == previous.formatId &&
+           record.length == previous.length && memcmp(record.text, previous.text, record.length) == 0;
+}
+
+// The summary is plain text in both modes; the binary decoder passes it through
+void Log::flushRepeats() {
+    if (previous.repeats == 0) {
+        return;
+    }
+    char summary[48];
+    snprintf(summary, sizeof(summary), "last message repeated %lu times", (unsigned long)previous.repeats);
+    if (previous.kind == KIND_TEXT) {
+        output(previous.level, previous.timestamp, summary);
     } else {
-        logWithSerial("DEBUG", format, args);
+        logWithSerial(previous.level, previous.timestamp, summary);
     }
-    
-    va_end(args);
+    previous.repeats = 0;
+    previous.valid = false;
 }
 
-void Log::notice(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    
+void Log::output(Level level, uint32_t timestamp, const char* text) {
     if (useElog && initialized) {
-        logWithElog(ELOG_LEVEL_NOTICE, format, args);
+        logWithElog(level, text);
     } else {
-        logWithSerial("NOTICE", format, args);
+        logWithSerial(level, timestamp, text);
     }
-    
-    va_end(args);
 }
 
-void Log::logWithElog(uint8_t elogLevel, const char* format, va_list args) {
-    // Use Elog's variadic logging
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    
-    switch(elogLevel) {
-        case ELOG_LEVEL_INFO:
-            Logger.info(MAIN_LOG, "%s", buffer);
+void Log::logWithElog(Level level, const char* text) {
+    switch(level) {
+        case LEVEL_INFO:
+            Logger.info(MAIN_LOG, "%s", text);
             break;
-        case ELOG_LEVEL_ERROR:
-            Logger.error(MAIN_LOG, "%s", buffer);
+        case LEVEL_ERROR:
+            Logger.error(MAIN_LOG, "%s", text);
             break;
-        case ELOG_LEVEL_WARNING:
-            Logger.warning(MAIN_LOG, "%s", buffer);
+        case LEVEL_WARNING:
+            Logger.warning(MAIN_LOG, "%s", text);
             break;
-        case ELOG_LEVEL_DEBUG:
-            Logger.debug(MAIN_LOG, "%s", buffer);
+        case LEVEL_DEBUG:
+            Logger.debug(MAIN_LOG, "%s", text);
             break;
-        case ELOG_LEVEL_NOTICE:
-            Logger.notice(MAIN_LOG, "%s", buffer);
+        case LEVEL_NOTICE:
+            Logger.notice(MAIN_LOG, "%s", text);
             break;
         default:
-            Logger.info(MAIN_LOG, "%s", buffer);
+            Logger.info(MAIN_LOG, "%s", text);
             break;
     }
 }
 
-void Log::logWithSerial(const char* level, const char* format, va_list args) {
-    // Get timestamp
-    unsigned long timestamp = millis();
-    
-    // Format the message
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    
-    // Print with timestamp and level
-    Serial.printf("[%08lu] [%s] %s\n", timestamp, level, buffer);
-    Serial.flush();  // Ensure immediate output
+void Log::logWithSerial(Level level, uint32_t timestamp, const char* text) {
+    // Timestamp is taken when the message was logged, not when it is drained
+    Serial.printf("[%08lu] [%s] %s\n", (unsigned long)timestamp, LEVEL_NAMES[level], text);
+}
+
+// Binary records go straight to Serial; Elog only handles text
+void Log::writeFrame(const Record& record) {
+    uint8_t frame[3 + 255 + 1];
+    uint8_t length = 0;
+    uint8_t* payload = frame + 3;
+
+    payload[length++] = record.formatId;
+    if (record.kind == KIND_DEFINITION) {
+        size_t formatLength = strnlen(record.format, MAX_DEFINITION_LENGTH);
+        memcpy(payload + length, record.format, formatLength);
+        length += formatLength;
+    } else {
+        payload[length++] = record.level | (record.truncated ? FRAME_TRUNCATED : 0);
+        memcpy(payload + length, &record.timestamp, sizeof(record.timestamp));
+        length += sizeof(record.timestamp);
+        memcpy(payload + length, record.text, record.length);
+        length += record.length;
+    }
+
+    frame[0] = FRAME_SYNC;
+    frame[1] = record.kind;
+    frame[2] = length;
+    uint8_t checksum = frame[1] + frame[2];
+    for (uint8_t i = 0; i < length; i++) {
+        checksum += payload[i];
+    }
+    payload[length] = checksum;
+    Serial.write(frame, 3 + length + 1);
+}
+
+uint32_t Log::getDroppedCount() {
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+void Log::logStats() {
+    LOG_REPORT("Log ring: %lu written, %lu dropped, peak depth %lu of %u",
+               (unsigned long)writtenCount.load(std::memory_order_relaxed),
+               (unsigned long)droppedCount.load(std::memory_order_relaxed),
+               (unsigned long)peakDepth.load(std::memory_order_relaxed), RING_SIZE);
+    LOG_REPORT("Log filtering: %lu rate-limited, %lu collapsed as repeats",
+               (unsigned long)rateLimitedCount.load(std::memory_order_relaxed),
+               (unsigned long)collapsedCount);
+    for (Site* site = sites; site != nullptr; site = site->next) {
+        if (site->totalSuppressed > 0) {
+            LOG_REPORT("  %lu suppressed: \"%.48s\"", (unsigned long)site->totalSuppressed, site->format);
+        }
+    }
 }
@@ -1,5 +1,4 @@
 #include <Arduino.h>
-#include <Wire.h>
 #include "state_machine.h"
 #include "display.h"
 #include "encoder.h"
@@ -7,15 +6,24 @@
 #include "settings.h"
 #include "rgbled.h"
 #include "logging.h"
+#include "events.h"
+#include "event_log.h"
+#include "console.h"
+#include "bus.h"
+#include "profiler.h"
+#include <esp_system.h>
+
+#define LOG_MODULE LOG_SYSTEM
 
 #define SCL_PIN 6
 #define SDA_PIN 5
 
 #define RTC_SQW_PIN 43
 
-// 32KB EEPROM
-#define EEPROM_I2C_ADDR 0x57
 #define RTC_I2C_ADDR 0x68
+#define DISPLAY_I2C_ADDR 0x70
+
+#define STATS_REPORT_INTERVAL_MS 60000
 
 void setup() {
   Serial.begin(115200);
@@ -24,30 +32,42 @@ void setup() {
   
   // Initialize custom Log module - set to false to use Serial fallback
   Log::init(false);  
-  Log::info("Starting Wake Clock...");
+#ifdef LOG_BINARY
+  Log::setBinaryMode(true); // Decode with tools/log_decode.py
+#endif
+  LOG_INFO("Starting Wake Clock...");
+
+  // Must be ready before any ISR that posts to it is attached
+  Events::init();
+
+  Bus::begin(SDA_PIN, SCL_PIN, 512);
+  LOG_INFO("I2C initialized");
 
-  Wire.begin(SDA_PIN, SCL_PIN);
-  Wire.setBufferSize(512);
-  Log::info("I2C initialized");
+  // The event log lives in the 32KB EEPROM at 0x57
+  if (EventLog::init()) {
+    EventLog::record(EventLog::BOOT, esp_reset_reason());
+  }
 
   // SCAN ALL I2C DEVICES
-  Log::info("Checking for RTC");
-  Wire.beginTransmission(RTC_I2C_ADDR);
-  if (Wire.endTransmission() != 0) {
-    Log::error("RTC not found!");
+  LOG_INFO("Checking for RTC");
+  uint8_t error = Bus::probe(RTC_I2C_ADDR, "probe");
+  if (error != 0) {
+    LOG_ERROR("RTC not found!");
+    EventLog::record(EventLog::I2C_ERROR, RTC_I2C_ADDR, error);
   } else {
-    Log::info("RTC found!");
+    LOG_INFO("RTC found!");
   }
-  Log::info("Checking for Display");
-  Wire.beginTransmission(0x70);
-  if (Wire.endTransmission() != 0) {
-    Log::error("Display not found!");
+  LOG_INFO("Checking for Display");
+  error = Bus::probe(DISPLAY_I2C_ADDR, "probe");
+  if (error != 0) {
+    LOG_ERROR("Display not found!");
+    EventLog::record(EventLog::I2C_ERROR, DISPLAY_I2C_ADDR, error);
   } else {
-    Log::info("Display found!");
+    LOG_INFO("Display found!");
   }
 
   if (!Settings::init()) {
-    Log::error("Failed to initialize settings!");
+    LOG_ERROR("Failed to initialize settings!");
   }
 
   Clock::init(RTC_SQW_PIN);
@@ -56,13 +76,66 @@ void setup() {
   Display::init();
   Encoder::init();
   StateMachine::init();
+  Console::init();
+#ifdef ENABLE_PROFILER
+  Profiler::init();
+#endif
 
   Clock::updateScheduleLED();
+  StateMachine::dispatch(); // Anything posted while the modules came up
+  Display::flush();
 }
 
+// The loop sleeps until an ISR or timer posts an event, so it does no work
+// between SQW ticks and input edges.
 void loop() {
-  Clock::update();  
-  Action action = Encoder::getAction();
-  StateMachine::processAction(action);
-  delay(10);
+  uint32_t events = Events::wait();
+  PROFILE_STAGE(Profiler::STAGE_LOOP);
+
+  if (events & EVENT_SQW_TICK) {
+    PROFILE_STAGE(Profiler::STAGE_CLOCK);
+    Clock::update();
+  }
+  ActionEvent input;
+  {
+    PROFILE_STAGE(Profiler::STAGE_INPUT);
+    input = Encoder::getAction();
+  }
+  StateMachine::post(input);
+  {
+    PROFILE_STAGE(Profiler::STAGE_DISPATCH);
+    StateMachine::dispatch();
+  }
+  {
+    PROFILE_STAGE(Profiler::STAGE_SETTINGS);
+    Settings::update();
+  }
+  {
+    PROFILE_STAGE(Profiler::STAGE_EVENT_LOG);
+    EventLog::update();
+  }
+  {
+    PROFILE_STAGE(Profiler::STAGE_DISPLAY);
+    Display::update();
+    Display::flush();
+  }
+  {
+    PROFILE_STAGE(Profiler::STAGE_CONSOLE);
+    Console::poll();
+  }
+
+  // The reports log at DEBUG, so they stay off the serial link until a
+  // module's level is raised
+  static unsigned long lastStatsReport = 0;
+  if (millis() - lastStatsReport >= STATS_REPORT_INTERVAL_MS) {
+    lastStatsReport = millis();
+    Events::logLatencyStats();
+    Settings::logWriteStats();
+    EventLog::logStats();
+    Bus::logStats();
+    RgbLed::logStats();
+    Encoder::logInputStats();
+    StateMachine::logQueueStats();
+    Log::logStats();
+  }
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include "state_machine.h"
+#include <cstring>
+
+// Static member definitions
+Profiler::Slot Profiler::stages[Profiler::STAGE_COUNT];
+Profiler::Slot Profiler::states[static_cast<uint8_t>(StateId::Count)][Profiler::STATE_SLOTS];
+uint32_t Profiler::cyclesPerMicro = 240;
+
+static const char* const STAGE_NAMES[Profiler::STAGE_COUNT] = {
+    "loop", "clock", "input", "dispatch", "settings", "event-log", "display", "console"
+};
+
+void Profiler::init() {
+    cyclesPerMicro = ESP.getCpuFreqMHz();
+    reset();
+}
+
+void Profiler::reset() {
+    memset(stages, 0, sizeof(stages));
+    memset(states, 0, sizeof(states));
+}
+
+void Profiler::recordStage(Stage stage, uint32_t cycles) {
+    record(stages[stage], cycles);
+}
+
+void Profiler::recordState(StateId state, uint8_t slot, uint32_t cycles) {
+    record(states[static_cast<uint8_t>(state)][slot], cycles);
+}
+
+// A few adds, one divide and a count-leading-zeros per sample
+void Profiler::record(Slot& slot, uint32_t cycles) {
+    if (slot.count == 0 || cycles < slot.minCycles) {
+        slot.minCycles = cycles;
+    }
+    if (cycles > slot.maxCycles) {
+        slot.maxCycles = cycles;
+    }
+    slot.count++;
+    slot.totalCycles += cycles;
+
+    uint32_t micros = cycles / cyclesPerMicro;
+    uint8_t bucket = (micros == 0) ? 0 : 32 - __builtin_clz(micros);
+    if (bucket >= BUCKETS) {
+        bucket = BUCKETS - 1;
+    }
+    if (slot.histogram[bucket] != UINT16_MAX) {
+        slot.histogram[bucket]++;
+    }
+}
+
+// State callbacks are timed inclusively: a handler that changes state
+// also pays for the onExit/onEnter it triggers
+void Profiler::dump(Print& out) {
+    out.printf("Profile (us; histogram buckets are log2 us, bucket b holds [2^(b-1), 2^b))\n");
+    for (uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        print(out, STAGE_NAMES[stage], "", stages[stage]);
+    }
+    for (uint8_t state = 0; state < static_cast<uint8_t>(StateId::Count); state++) {
+        for (uint8_t slot = 0; slot < STATE_SLOTS; slot++) {
+            const char* detail = (slot == SLOT_ON_ENTER) ? "enter"
+                               : (slot == SLOT_ON_EXIT) ? "exit"
+                               : StateMachine::getActionName(static_cast<Action>(slot));
+            print(out, StateMachine::getStateName(static_cast<StateId>(state)), detail, states[state][slot]);
+        }
+    }
+}
+
+void Profiler::print(Print& out, const char* name, const char* detail, const Slot& slot) {
+    if (slot.count == 0) {
+        return;
+    }
+    out.printf("  %s%s%s: n=%lu min %lu mean %lu max %lu |", name, detail[0] ? " " : "", detail,
+               (unsigned long)slot.count, (unsigned long)(slot.minCycles / cyclesPerMicro),
+               (unsigned long)(slot.totalCycles / slot.count / cyclesPerMicro),
+               (unsigned long)(slot.maxCycles / cyclesPerMicro));
+
+    // Only the populated range of buckets, labelled with its first bucket
+    uint8_t first = 0;
+    uint8_t last = BUCKETS - 1;
+    while (slot.histogram[first] == 0) first++;
+    while (slot.histogram[last] == 0) last--;
+    out.printf(" b%u:", first);
+    for (uint8_t bucket = first; bucket <= last; bucket++) {
+        out.printf(" %u", slot.histogram[bucket]);
+    }
+    out.printf("\n");
+}
+
+#endif // ENABLE_PROFILER
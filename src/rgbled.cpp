@@ -1,32 +1,126 @@
 #include "rgbled.h"
 #include "settings.h"
+#include "logging.h"
 #include <schedule.h>
 #include <Adafruit_NeoPixel.h>
+#include <array>
+
+#define LOG_MODULE LOG_LED
 
 #define DATA_PIN 44
 #define NUMPIXELS 16
 
+#define LED_TASK_STACK 2048
+#define LED_TASK_PRIORITY 1
+#define LED_TASK_CORE 0 // Keep show() off the core running loop()
+
 Adafruit_NeoPixel pixels(NUMPIXELS, DATA_PIN, NEO_GRB + NEO_KHZ800);
 
+namespace {
+
+constexpr double constexprSqrt(double x) {
+    double root = 1.0;
+    for (int i = 0; i < 32; i++) {
+        root = 0.5 * (root + x / root);
+    }
+    return root;
+}
+
+// 8-bit perceptual to linear PWM curve, gamma 2.25 (x^2 * x^0.25), so
+// crossfades look even instead of rushing through the bright half
+constexpr std::array<uint8_t, 256> makeGammaTable() {
+    std::array<uint8_t, 256> table{};
+    for (int i = 0; i < 256; i++) {
+        double x = i / 255.0;
+        double y = x * x * constexprSqrt(constexprSqrt(x));
+        table[i] = static_cast<uint8_t>(y * 255.0 + 0.5);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> GAMMA = makeGammaTable();
+
+static_assert(GAMMA[0] == 0 && GAMMA[255] == 255, "gamma table must span 0-255");
+
+// Gamma applies to colour only. Brightness stays linear, as it was with
+// setBrightness(), so the stored setting keeps its meaning.
+inline uint8_t scaleChannel(uint8_t value, uint8_t brightness) {
+    return (GAMMA[value] * (brightness + 1)) >> 8;
+}
+
+// progress is an 8.8 fraction: 0 = from, 256 = to
+inline uint8_t lerp(uint8_t from, uint8_t to, uint16_t progress) {
+    return (from * (256 - progress) + to * progress) >> 8;
+}
+
+} // namespace
+
+// Static member definitions
+uint8_t RgbLed::currentBrightness = 0;
+ScheduleBlock RgbLed::currentBlock = NO_BLOCK;
+RgbLed::Frame RgbLed::target = {0, 0, 0, 0};
+RgbLed::Frame RgbLed::pending = {0, 0, 0, 0};
+bool RgbLed::framePending = false;
+bool RgbLed::pendingFade = false;
+portMUX_TYPE RgbLed::frameLock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t RgbLed::taskHandle = nullptr;
+esp_timer_handle_t RgbLed::frameTimer = nullptr;
+RgbLed::Frame RgbLed::shown = {0, 0, 0, 0};
+RgbLed::Fade RgbLed::fade = {{0, 0, 0, 0}, {0, 0, 0, 0}, 0, false};
+uint32_t RgbLed::frameIntervalUs = RgbLed::FRAME_INTERVAL_US;
+uint32_t RgbLed::framesRequested = 0;
+uint32_t RgbLed::framesSkipped = 0;
+uint32_t RgbLed::framesShown = 0;
+uint32_t RgbLed::fadeFrames = 0;
+uint32_t RgbLed::fadeThrottles = 0;
+uint32_t RgbLed::maxFrameCostUs = 0;
+uint32_t RgbLed::showHistogram[RgbLed::SHOW_HISTOGRAM_BUCKETS] = {0};
+
 void RgbLed::init() {
+    currentBrightness = Settings::getLedBrightness();
+    target.brightness = currentBrightness;
+
+    // render() scales by brightness itself, so the library's lossy
+    // setBrightness() is never used
     pixels.begin();
-    pixels.setBrightness(Settings::getLedBrightness());
     pixels.show(); // Initialize all pixels to 'off'
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = frameTimerCallback;
+    timerArgs.name = "led_frame";
+    if (esp_timer_create(&timerArgs, &frameTimer) != ESP_OK) {
+        LOG_ERROR("Failed to create LED frame timer, fades disabled");
+        frameTimer = nullptr;
+    }
+
+    if (xTaskCreatePinnedToCore(ledTask, "led", LED_TASK_STACK, nullptr,
+                                LED_TASK_PRIORITY, &taskHandle, LED_TASK_CORE) != pdPASS) {
+        LOG_ERROR("Failed to start LED task");
+        taskHandle = nullptr;
+    }
+
+    // Anything requested before init goes out now
+    postFrame(false);
 }
 
 void RgbLed::indicateStatus(ScheduleBlock scheduleBlock) {
+    // Only the gentle transitions into sleep and wake crossfade
+    bool fade = (currentBlock == WIND_DOWN && scheduleBlock == SLEEP) ||
+                (currentBlock == QUIET && scheduleBlock == WAKE);
+    currentBlock = scheduleBlock;
+
     switch (scheduleBlock) {
         case WIND_DOWN:
-            setColor(0, 0, 255); // Blue
+            setColor(0, 0, 255, fade); // Blue
             break;
         case SLEEP:
-            setColor(255, 0, 0); // Red
+            setColor(255, 0, 0, fade); // Red
             break;
         case QUIET:
-            setColor(255, 255, 0); // Yellow
+            setColor(255, 255, 0, fade); // Yellow
             break;
         case WAKE:
-            setColor(0, 255, 0); // Green
+            setColor(0, 255, 0, fade); // Green
             break;
         case NO_BLOCK:
             turnOff();
@@ -35,19 +129,168 @@ void RgbLed::indicateStatus(ScheduleBlock scheduleBlock) {
 }
 
 void RgbLed::turnOff() {
-    pixels.clear();
-    pixels.show();
+    currentBlock = NO_BLOCK;
+    setColor(0, 0, 0, false);
 }
 
-void RgbLed::setColor(uint8_t red, uint8_t green, uint8_t blue) {
-    for (int i = 0; i < NUMPIXELS; i++) {
-        pixels.setPixelColor(i, pixels.Color(red, green, blue));
+void RgbLed::setColor(uint8_t red, uint8_t green, uint8_t blue, bool fade) {
+    Frame frame = {red, green, blue, currentBrightness};
+    framesRequested++;
+    if (frame == target) {
+        framesSkipped++;
+        return;
     }
-    pixels.show();
+    target = frame;
+    postFrame(fade);
 }
 
 void RgbLed::setBrightness(uint8_t brightness) {
-    pixels.setBrightness(brightness);
+    currentBrightness = brightness;
     Settings::setLedBrightness(brightness);
-    pixels.show(); // Update display with new brightness
+    setColor(target.red, target.green, target.blue, false); // Update display with new brightness
+}
+
+// Hand the target frame to the LED task. If it is still busy with an older
+// frame, that one is simply replaced, so at most one frame is queued.
+void RgbLed::postFrame(bool fade) {
+    if (taskHandle == nullptr) {
+        return;
+    }
+    portENTER_CRITICAL(&frameLock);
+    pending = target;
+    pendingFade = fade;
+    framePending = true;
+    portEXIT_CRITICAL(&frameLock);
+    xTaskNotify(taskHandle, NOTIFY_FRAME, eSetBits);
+}
+
+// Runs in the esp_timer task; the frame itself is built by the LED task
+void RgbLed::frameTimerCallback(void* arg) {
+    xTaskNotify(taskHandle, NOTIFY_TICK, eSetBits);
+}
+
+void RgbLed::ledTask(void* arg) {
+    for (;;) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+        if (bits & NOTIFY_FRAME) {
+            portENTER_CRITICAL(&frameLock);
+            Frame frame = pending;
+            bool hasFrame = framePending;
+            bool fadeIn = pendingFade;
+            framePending = false;
+            portEXIT_CRITICAL(&frameLock);
+
+            if (hasFrame) {
+                bool sameColor = frame.red == fade.to.red && frame.green == fade.to.green &&
+                                 frame.blue == fade.to.blue;
+                if (fade.active && sameColor) {
+                    // Brightness changed mid-fade: keep fading towards the new level
+                    fade.to.brightness = frame.brightness;
+                } else if (fadeIn && frameTimer != nullptr) {
+                    startFade(frame);
+                } else {
+                    stopFade();
+                    render(frame);
+                }
+            }
+        }
+
+        if ((bits & NOTIFY_TICK) && fade.active) {
+            stepFade();
+        }
+    }
+}
+
+void RgbLed::startFade(const Frame& to) {
+    fade.from = shown;
+    fade.to = to;
+    fade.startUs = esp_timer_get_time();
+    fade.active = true;
+    frameIntervalUs = FRAME_INTERVAL_US;
+    esp_timer_stop(frameTimer);
+    esp_timer_start_periodic(frameTimer, frameIntervalUs);
+}
+
+void RgbLed::stopFade() {
+    if (fade.active) {
+        esp_timer_stop(frameTimer);
+        fade.active = false;
+    }
+}
+
+// Build and show one fade frame. If frames cost more than the CPU budget the
+// frame rate is halved, and past the slowest rate the fade just completes.
+void RgbLed::stepFade() {
+    int64_t start = esp_timer_get_time();
+    int64_t elapsed = start - fade.startUs;
+    const int64_t durationUs = (int64_t)FADE_DURATION_MS * 1000;
+    uint16_t progress = (elapsed >= durationUs) ? 256 : (uint16_t)(elapsed * 256 / durationUs);
+
+    Frame frame = {
+        lerp(fade.from.red, fade.to.red, progress),
+        lerp(fade.from.green, fade.to.green, progress),
+        lerp(fade.from.blue, fade.to.blue, progress),
+        lerp(fade.from.brightness, fade.to.brightness, progress),
+    };
+    render(frame);
+    fadeFrames++;
+
+    if (progress >= 256) {
+        stopFade();
+        return;
+    }
+
+    uint32_t cost = (uint32_t)(esp_timer_get_time() - start);
+    if (cost > maxFrameCostUs) {
+        maxFrameCostUs = cost;
+    }
+    if (cost * 100 > frameIntervalUs * CPU_BUDGET_PERCENT) {
+        fadeThrottles++;
+        if (frameIntervalUs * 2 <= MAX_FRAME_INTERVAL_US) {
+            frameIntervalUs *= 2;
+            esp_timer_stop(frameTimer);
+            esp_timer_start_periodic(frameTimer, frameIntervalUs);
+        } else {
+            stopFade();
+            render(fade.to);
+        }
+    }
+}
+
+void RgbLed::render(const Frame& frame) {
+    // Fill the whole buffer in one call, then clock it out over RMT
+    pixels.fill(pixels.Color(scaleChannel(frame.red, frame.brightness),
+                             scaleChannel(frame.green, frame.brightness),
+                             scaleChannel(frame.blue, frame.brightness)));
+    unsigned long start = micros();
+    pixels.show();
+    unsigned long elapsed = micros() - start;
+    shown = frame;
+
+    uint8_t bucket = 0;
+    while (elapsed >= 2 && bucket < SHOW_HISTOGRAM_BUCKETS - 1) {
+        elapsed >>= 1;
+        bucket++;
+    }
+    showHistogram[bucket]++;
+    framesShown++;
+}
+
+void RgbLed::logStats() {
+    LOG_REPORT("LED: %lu frames requested, %lu skipped as unchanged, %lu shown",
+                (unsigned long)framesRequested, (unsigned long)framesSkipped,
+                (unsigned long)framesShown);
+    LOG_REPORT("LED fades: %lu frames, max frame cost %lu us, %lu throttled",
+                (unsigned long)fadeFrames, (unsigned long)maxFrameCostUs,
+                (unsigned long)fadeThrottles);
+
+    char histogram[SHOW_HISTOGRAM_BUCKETS * 11 + 1];
+    size_t used = 0;
+    for (uint8_t i = 0; i < SHOW_HISTOGRAM_BUCKETS && used < sizeof(histogram); i++) {
+        used += snprintf(histogram + used, sizeof(histogram) - used, " %lu",
+                         (unsigned long)showHistogram[i]);
+    }
+    LOG_REPORT("LED show() time histogram (log2 us buckets):%s", histogram);
 }
@@ -38,6 +38,18 @@ Schedule Schedule::fromByteArray(const std::array<uint8_t, 10>& data) {
     return schedule;
 }
 
+Schedule Schedule::fromBoundaries(const std::array<uint16_t, 5>& boundaries) {
+    Schedule schedule;
+    
+    schedule.winddownStart = boundaries[0];
+    schedule.sleepStart = boundaries[1];
+    schedule.quietStart = boundaries[2];
+    schedule.wakeStart = boundaries[3];
+    schedule.wakeEnd = boundaries[4];
+    
+    return schedule;
+}
+
 std::array<uint8_t, 10> Schedule::convertToByteArray() const {
     std::array<uint8_t, 10> data = {
         static_cast<uint8_t>(winddownStart / 60),   // hour
@@ -89,8 +101,10 @@ bool Schedule::isActive() const {
 }
 
 ScheduleBlock Schedule::getCurrentBlock() const {
-    uint16_t currentMinutes = Clock::getMinutesSinceMidnight();
+    return getBlockAt(Clock::getMinutesSinceMidnight());
+}
 
+ScheduleBlock Schedule::getBlockAt(uint16_t currentMinutes) const {
     // Helper function to check if current time is within a range, handling day wrapping
     auto isInRange = [](uint16_t current, uint16_t start, uint16_t end) -> bool {
         if (start <= end) {
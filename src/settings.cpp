@@ -1,12 +1,107 @@
 #include "settings.h"
 #include "schedule.h"
 #include "logging.h"
+#include "events.h"
+#include "event_log.h"
 #include <Preferences.h>
 #include <cstring>
 
+#define LOG_MODULE LOG_SETTINGS
+
 // Static member definitions
 Preferences Settings::preferences;
 bool Settings::initialized = false;
+Settings::Cache Settings::cache;
+const char* const Settings::IMAGE_SLOT_KEYS[2] = {"cfg_a", "cfg_b"};
+uint8_t Settings::activeSlot = 1;
+uint32_t Settings::imageSequence = 0;
+uint32_t Settings::nvsReads = 0;
+uint32_t Settings::nvsWrites = 0;
+uint8_t Settings::pendingWrites = 0;
+unsigned long Settings::lastDeferredChange = 0;
+uint32_t Settings::deferredRequests = 0;
+uint32_t Settings::deferredCommits = 0;
+uint32_t Settings::commitMicros = 0;
+
+static const uint8_t DEFAULT_DISPLAY_BRIGHTNESS = 3;
+static const uint8_t DEFAULT_LED_BRIGHTNESS = 128; // 50% of 255
+static const uint8_t SCHEDULE_TIME_BITS = 12;      // Minutes, with headroom for naps past midnight
+
+namespace {
+
+// Sequential bit packing helpers for the settings image payload
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* buffer) : buffer(buffer), bit(0) {}
+
+    void put(uint32_t value, uint8_t bits) {
+        for (uint8_t i = 0; i < bits; i++, bit++) {
+            if (value & (1UL << i)) {
+                buffer[bit / 8] |= (1 << (bit % 8));
+            }
+        }
+    }
+
+private:
+    uint8_t* buffer;
+    size_t bit;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const uint8_t* buffer) : buffer(buffer), bit(0) {}
+
+    uint32_t get(uint8_t bits) {
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < bits; i++, bit++) {
+            if (buffer[bit / 8] & (1 << (bit % 8))) {
+                value |= (1UL << i);
+            }
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* buffer;
+    size_t bit;
+};
+
+uint32_t crc32(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+void putUint32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+uint32_t getUint32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void putSchedule(BitWriter& writer, const Schedule& schedule) {
+    for (uint16_t minutes : schedule.getBoundaries()) {
+        writer.put(minutes, SCHEDULE_TIME_BITS);
+    }
+}
+
+Schedule getSchedule(BitReader& reader) {
+    std::array<uint16_t, 5> boundaries;
+    for (uint16_t& minutes : boundaries) {
+        minutes = reader.get(SCHEDULE_TIME_BITS);
+    }
+    return Schedule::fromBoundaries(boundaries);
+}
+
+} // namespace
 
 bool Settings::init() {
     if (initialized) {
@@ -15,57 +110,172 @@ bool Settings::init() {
     
     // Open preferences in read-write mode
     if (!preferences.begin("wake-clock", false)) {
-        Log::error("Failed to initialize preferences");
+        LOG_ERROR("Failed to initialize preferences");
         return false;
     }
     
-    // Check if this is the first time initialization
-    if (!preferences.getBool("initialized", false)) {
-        Log::info("First time setup - initializing default schedules");
-        initializeDefaults();
-        preferences.putBool("initialized", true);
+    initialized = true;
+    
+    if (!loadImage()) {
+        migrateLegacyKeys();
     }
     
-    initialized = true;
-    Log::info("Settings initialized successfully");
+    LOG_INFO("Settings initialized successfully (image seq %lu, slot %d)",
+              (unsigned long)imageSequence, activeSlot);
     return true;
 }
 
-bool Settings::saveSchedule(DayOfWeek day, const Schedule& schedule) {
-    if (!initialized) {
-        Log::error("Settings not initialized");
-        return false;
+bool Settings::loadImage() {
+    bool found = false;
+    
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        uint8_t image[IMAGE_SIZE];
+        size_t length = preferences.getBytes(IMAGE_SLOT_KEYS[slot], image, sizeof(image));
+        nvsReads++;
+        
+        uint32_t sequence;
+        Cache decoded;
+        if (!decodeImage(image, length, sequence, decoded)) {
+            continue;
+        }
+        
+        // Keep whichever valid image is newest (wrap-safe comparison)
+        if (!found || (int32_t)(sequence - imageSequence) > 0) {
+            found = true;
+            cache = decoded;
+            activeSlot = slot;
+            imageSequence = sequence;
+        }
     }
     
-    String key = getDayKey(day);
-    
-    // Convert schedule to byte array
-    std::array<uint8_t, 10> scheduleData = schedule.convertToByteArray();
+    return found;
+}
+
+void Settings::encodeImage(uint32_t sequence, uint8_t image[IMAGE_SIZE]) {
+    memset(image, 0, IMAGE_SIZE);
+    image[0] = IMAGE_VERSION;
+    putUint32(image + 1, sequence);
     
-    size_t bytesWritten = preferences.putBytes(key.c_str(), scheduleData.data(), scheduleData.size());
+    BitWriter writer(image + 5);
+    for (int day = 0; day < 7; day++) {
+        putSchedule(writer, cache.schedules[day]);
+    }
+    putSchedule(writer, cache.napSchedule);
+    writer.put(cache.napEnabled, 1);
+    writer.put(cache.locked, 1);
+    writer.put(cache.displayBrightness, 4);
+    writer.put(cache.ledBrightness, 8);
     
-    if (bytesWritten != scheduleData.size()) {
-        Log::error("Failed to save schedule for day %d", day);
+    putUint32(image + 5 + IMAGE_PAYLOAD_SIZE, crc32(image, 5 + IMAGE_PAYLOAD_SIZE));
+}
+
+bool Settings::decodeImage(const uint8_t image[IMAGE_SIZE], size_t length, uint32_t& sequence, Cache& out) {
+    if (length != IMAGE_SIZE) {
         return false;
     }
-
-    Log::info("Schedule saved for day %d", day);
+    if (getUint32(image + 5 + IMAGE_PAYLOAD_SIZE) != crc32(image, 5 + IMAGE_PAYLOAD_SIZE)) {
+        LOG_WARNING("Settings image CRC mismatch, ignoring slot");
+        return false;
+    }
+    
+    // Newer layouts get their own case here, converting into the current Cache
+    switch (image[0]) {
+        case 1: {
+            BitReader reader(image + 5);
+            for (int day = 0; day < 7; day++) {
+                out.schedules[day] = getSchedule(reader);
+            }
+            out.napSchedule = getSchedule(reader);
+            out.napEnabled = reader.get(1);
+            out.locked = reader.get(1);
+            out.displayBrightness = reader.get(4);
+            out.ledBrightness = reader.get(8);
+            break;
+        }
+        default:
+            LOG_WARNING("Unknown settings image version %d", image[0]);
+            return false;
+    }
+    
+    sequence = getUint32(image + 1);
     return true;
 }
 
-bool Settings::loadSchedule(DayOfWeek day, Schedule& schedule) {
+bool Settings::commit() {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    String key = getDayKey(day);
+    uint8_t image[IMAGE_SIZE];
+    uint8_t slot = activeSlot ^ 1;
+    encodeImage(imageSequence + 1, image);
+    
+    size_t bytesWritten = preferences.putBytes(IMAGE_SLOT_KEYS[slot], image, sizeof(image));
+    nvsWrites++;
+    
+    if (bytesWritten != sizeof(image)) {
+        LOG_ERROR("Failed to commit settings image to slot %d", slot);
+        return false;
+    }
+    
+    activeSlot = slot;
+    imageSequence++;
+    EventLog::record(EventLog::SETTINGS_WRITE, slot, 0, imageSequence);
+    // Anything deferred went out with this image
+    pendingWrites = 0;
+    return true;
+}
+
+// Build the first image from the per-key layout used before the settings
+// image existed, or from defaults on a fresh device
+void Settings::migrateLegacyKeys() {
+    nvsReads++;
+    if (!preferences.getBool("initialized", false)) {
+        LOG_INFO("First time setup - initializing default schedules");
+        initializeDefaults();
+        return;
+    }
+    
+    LOG_INFO("Migrating settings from per-key storage");
+    for (int day = 0; day < 7; day++) {
+        if (!readScheduleBlob(getDayKey(static_cast<DayOfWeek>(day)), cache.schedules[day])) {
+            LOG_ERROR("Failed to load schedule for day %d, using defaults", day);
+        }
+    }
+    if (!readScheduleBlob("nap_schedule", cache.napSchedule)) {
+        LOG_WARNING("Failed to load nap schedule, using defaults");
+    }
+    cache.napEnabled = preferences.getBool("nap_schedule_enabled", false);
+    cache.locked = preferences.getBool("device_locked", false);
+    cache.displayBrightness = preferences.getUChar("display_lvl", DEFAULT_DISPLAY_BRIGHTNESS);
+    cache.ledBrightness = preferences.getUChar("led_lvl", DEFAULT_LED_BRIGHTNESS);
+    nvsReads += 4;
+    if (cache.displayBrightness > 15) cache.displayBrightness = 15;
+    
+    // Only drop the old keys once the image is safely written
+    if (commit()) {
+        static const char* const legacyKeys[] = {
+            "nap_schedule", "nap_schedule_enabled", "device_locked",
+            "display_lvl", "led_lvl", "initialized"
+        };
+        for (int day = 0; day < 7; day++) {
+            preferences.remove(getDayKey(static_cast<DayOfWeek>(day)));
+        }
+        for (const char* key : legacyKeys) {
+            preferences.remove(key);
+        }
+        LOG_INFO("Settings migrated to image format v%d", IMAGE_VERSION);
+    }
+}
+
+bool Settings::readScheduleBlob(const char* key, Schedule& schedule) {
     uint8_t scheduleData[10];
     
-    size_t bytesRead = preferences.getBytes(key.c_str(), scheduleData, sizeof(scheduleData));
+    size_t bytesRead = preferences.getBytes(key, scheduleData, sizeof(scheduleData));
+    nvsReads++;
     
     if (bytesRead != sizeof(scheduleData)) {
-        Log::error("Failed to load schedule for day %d, using defaults", day);
         schedule = Schedule();
         return false;
     }
@@ -78,6 +288,43 @@ bool Settings::loadSchedule(DayOfWeek day, Schedule& schedule) {
     return true;
 }
 
+bool Settings::saveSchedule(DayOfWeek day, const Schedule& schedule) {
+    if (!initialized) {
+        LOG_ERROR("Settings not initialized");
+        return false;
+    }
+    
+    if (day < 0 || day > 6) {
+        LOG_ERROR("Invalid day %d", day);
+        return false;
+    }
+    
+    cache.schedules[day] = schedule;
+    
+    if (!commit()) {
+        LOG_ERROR("Failed to save schedule for day %d", day);
+        return false;
+    }
+
+    LOG_INFO("Schedule saved for day %d", day);
+    return true;
+}
+
+bool Settings::loadSchedule(DayOfWeek day, Schedule& schedule) {
+    if (!initialized) {
+        LOG_ERROR("Settings not initialized");
+        return false;
+    }
+    
+    if (day < 0 || day > 6) {
+        schedule = Schedule();
+        return false;
+    }
+    
+    schedule = cache.schedules[day];
+    return true;
+}
+
 bool Settings::loadAllSchedules(Schedule schedules[7]) {
     bool allSuccess = true;
     
@@ -90,16 +337,24 @@ bool Settings::loadAllSchedules(Schedule schedules[7]) {
     return allSuccess;
 }
 
+// The whole week goes out in a single image write
 bool Settings::saveAllSchedules(const Schedule schedules[7]) {
-    bool allSuccess = true;
+    if (!initialized) {
+        LOG_ERROR("Settings not initialized");
+        return false;
+    }
     
     for (int day = 0; day < 7; day++) {
-        if (!saveSchedule(static_cast<DayOfWeek>(day), schedules[day])) {
-            allSuccess = false;
-        }
+        cache.schedules[day] = schedules[day];
     }
     
-    return allSuccess;
+    if (!commit()) {
+        LOG_ERROR("Failed to save schedules");
+        return false;
+    }
+    
+    LOG_INFO("Schedules saved for all days");
+    return true;
 }
 
 bool Settings::resetSchedule(DayOfWeek day) {
@@ -108,41 +363,92 @@ bool Settings::resetSchedule(DayOfWeek day) {
 }
 
 bool Settings::resetAllSchedules() {
-    bool allSuccess = true;
-    Schedule defaultSchedule = getDefaultSchedule();
-    
+    Schedule defaultSchedules[7];
     for (int day = 0; day < 7; day++) {
-        if (!saveSchedule(static_cast<DayOfWeek>(day), defaultSchedule)) {
-            allSuccess = false;
-        }
+        defaultSchedules[day] = getDefaultSchedule();
     }
-    
-    return allSuccess;
+    return saveAllSchedules(defaultSchedules);
 }
 
 bool Settings::isInitialized() {
-    return initialized && preferences.getBool("initialized", false);
+    return initialized;
+}
+
+Schedule Settings::getDefaultSchedule() {
+    return Schedule();
 }
 
 void Settings::close() {
     if (initialized) {
+        flush();
         preferences.end();
         initialized = false;
-        Log::info("Settings closed");
+        LOG_INFO("Settings closed");
     }
 }
 
-String Settings::getDayKey(DayOfWeek day) {
-    const char* dayNames[] = {
-        "sunday", "monday", "tuesday", "wednesday", 
-        "thursday", "friday", "saturday"
+void Settings::deferWrite(PendingWrite write) {
+    pendingWrites |= write;
+    lastDeferredChange = millis();
+    deferredRequests++;
+    // Make sure the event loop comes back to commit once things go quiet
+    Events::wakeAfter(COMMIT_QUIET_MS);
+}
+
+void Settings::update() {
+    if (pendingWrites == 0) {
+        return;
+    }
+    unsigned long quietMs = millis() - lastDeferredChange;
+    if (quietMs >= COMMIT_QUIET_MS) {
+        flush();
+    } else {
+        // Woken early for something else; the earlier wake-up replaced ours
+        Events::wakeAfter(COMMIT_QUIET_MS - quietMs);
+    }
+}
+
+void Settings::flush() {
+    if (pendingWrites == 0 || !initialized) {
+        return;
+    }
+    
+    uint8_t written = pendingWrites;
+    unsigned long start = micros();
+    if (commit()) {
+        deferredCommits++;
+        if (written & PENDING_DISPLAY_BRIGHTNESS) {
+            LOG_INFO("Display brightness saved: %d", cache.displayBrightness);
+        }
+        if (written & PENDING_LED_BRIGHTNESS) {
+            LOG_INFO("LED brightness saved: %d", cache.ledBrightness);
+        }
+    }
+    commitMicros += micros() - start;
+}
+
+void Settings::logWriteStats() {
+    // Write amplification avoided = requested / committed, shown with one decimal
+    [[maybe_unused]] uint32_t ratioTenths = deferredCommits == 0 ? 0 : deferredRequests * 10 / deferredCommits;
+    LOG_REPORT("Settings: %lu deferred writes coalesced into %lu NVS commits (%lu.%lux), %lu us committing",
+                (unsigned long)deferredRequests, (unsigned long)deferredCommits,
+                (unsigned long)(ratioTenths / 10), (unsigned long)(ratioTenths % 10),
+                (unsigned long)commitMicros);
+    LOG_REPORT("Settings: %lu NVS reads, %lu NVS writes since boot",
+                (unsigned long)nvsReads, (unsigned long)nvsWrites);
+}
+
+const char* Settings::getDayKey(DayOfWeek day) {
+    static const char* const dayKeys[] = {
+        "sched_sunday", "sched_monday", "sched_tuesday", "sched_wednesday",
+        "sched_thursday", "sched_friday", "sched_saturday"
     };
     
     if (day >= 0 && day <= 6) {
-        return String("sched_") + dayNames[day];
+        return dayKeys[day];
     }
     
-    return String("sched_invalid");
+    return "sched_invalid";
 }
 
 void Settings::initializeDefaults() {
@@ -150,69 +456,58 @@ void Settings::initializeDefaults() {
     
     // Initialize all days with the same default schedule
     for (int day = 0; day < 7; day++) {
-        saveSchedule(static_cast<DayOfWeek>(day), defaultSchedule);
+        cache.schedules[day] = defaultSchedule;
     }
 
     // Initialize nap schedule as inactive
-    Schedule defaultNap = Schedule::getNap(30); // Default nap duration of 30 minutes
-    saveNapSchedule(defaultSchedule);
-    setNapEnabled(false);
+    cache.napSchedule = defaultSchedule;
+    cache.napEnabled = false;
+    cache.locked = false;
+    cache.displayBrightness = DEFAULT_DISPLAY_BRIGHTNESS;
+    cache.ledBrightness = DEFAULT_LED_BRIGHTNESS;
 
-    Log::info("Default schedules initialized for all days");
+    commit();
+    LOG_INFO("Default schedules initialized for all days");
 }
 
 bool Settings::saveNapSchedule(const Schedule& napSchedule) {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    // Convert schedule to byte array
-    std::array<uint8_t, 10> napData = napSchedule.convertToByteArray();
+    cache.napSchedule = napSchedule;
     
-    size_t bytesWritten = preferences.putBytes("nap_schedule", napData.data(), napData.size());
-    
-    if (bytesWritten != napData.size()) {
-        Log::error("Failed to save nap schedule");
+    if (!commit()) {
+        LOG_ERROR("Failed to save nap schedule");
         return false;
     }
 
-    Log::info("Nap schedule saved");
+    LOG_INFO("Nap schedule saved");
     return true;
 }
 
 bool Settings::loadNapSchedule(Schedule& napSchedule) {
     if (!initialized) {
-        Log::error("Settings not initialized");
-        return false;
-    }
-    
-    uint8_t napData[10];
-    
-    size_t bytesRead = preferences.getBytes("nap_schedule", napData, sizeof(napData));
-    
-    if (bytesRead != sizeof(napData)) {
-        Log::warning("Failed to load nap schedule, using defaults");
-        napSchedule = Schedule(); // Default schedule
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    // Convert byte array to Schedule object
-    std::array<uint8_t, 10> dataArray;
-    std::copy(napData, napData + 10, dataArray.begin());
-    napSchedule = Schedule::fromByteArray(dataArray);
-    
+    napSchedule = cache.napSchedule;
     return true;
 }
 
 bool Settings::setNapEnabled(bool enabled) {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    preferences.putBool("nap_schedule_enabled", enabled);
-    Log::info("Nap enabled state set to: %s", enabled ? "true" : "false");
+    cache.napEnabled = enabled;
+    if (!commit()) {
+        return false;
+    }
+    LOG_INFO("Nap enabled state set to: %s", enabled ? "true" : "false");
     return true;
 }
 
@@ -221,39 +516,42 @@ bool Settings::isNapEnabled() {
         return false;
     }
     
-    return preferences.getBool("nap_schedule_enabled", false);
+    return cache.napEnabled;
 }
 
 bool Settings::startNap(uint16_t durationMinutes) {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
     // This function is now deprecated in favor of Clock::startNap
     // which has access to the current time
-    Log::warning("Settings::startNap is deprecated, use Clock::startNap instead");
+    LOG_WARNING("Settings::startNap is deprecated, use Clock::startNap instead");
     return false;
 }
 
 bool Settings::stopNap() {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    Log::info("Stopping nap");
+    LOG_INFO("Stopping nap");
     return setNapEnabled(false);
 }
 
 bool Settings::setLocked(bool locked) {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    preferences.putBool("device_locked", locked);
-    Log::info("Device lock state set to: %s", locked ? "true" : "false");
+    cache.locked = locked;
+    if (!commit()) {
+        return false;
+    }
+    LOG_INFO("Device lock state set to: %s", locked ? "true" : "false");
     return true;
 }
 
@@ -262,46 +560,46 @@ bool Settings::isLocked() {
         return false;
     }
     
-    return preferences.getBool("device_locked", false);
+    return cache.locked;
 }
 
 bool Settings::setDisplayBrightness(uint8_t brightness) {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
     // Clamp brightness to valid range (0-15 for HT16K33)
     if (brightness > 15) brightness = 15;
     
-    preferences.putUChar("display_lvl", brightness);
-    Log::info("Display brightness set to: %d", brightness);
+    cache.displayBrightness = brightness;
+    deferWrite(PENDING_DISPLAY_BRIGHTNESS);
     return true;
 }
 
 uint8_t Settings::getDisplayBrightness() {
     if (!initialized) {
-        return 3; // Default brightness
+        return DEFAULT_DISPLAY_BRIGHTNESS;
     }
     
-    return preferences.getUChar("display_lvl", 3);
+    return cache.displayBrightness;
 }
 
 bool Settings::setLedBrightness(uint8_t brightness) {
     if (!initialized) {
-        Log::error("Settings not initialized");
+        LOG_ERROR("Settings not initialized");
         return false;
     }
     
-    preferences.putUChar("led_lvl", brightness);
-    Log::info("LED brightness set to: %d", brightness);
+    cache.ledBrightness = brightness;
+    deferWrite(PENDING_LED_BRIGHTNESS);
     return true;
 }
 
 uint8_t Settings::getLedBrightness() {
     if (!initialized) {
-        return 128; // Default brightness (50% of 255)
+        return DEFAULT_LED_BRIGHTNESS;
     }
     
-    return preferences.getUChar("led_lvl", 128);
+    return cache.ledBrightness;
 }
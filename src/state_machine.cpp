@@ -4,32 +4,195 @@
 #include "settings.h"
 #include "schedule.h"
 #include "logging.h"
+#include "encoder.h"
+#include "event_log.h"
+#include "profiler.h"
 
-State* currentState = nullptr;
+#define LOG_MODULE LOG_INPUT
+
+namespace {
+
+struct StateEntry {
+  StateId id;
+  const State* state;
+  const char* name;
+};
+
+// Every StateId maps to its state here, checked at compile time
+constexpr StateEntry STATES[] = {
+  {StateId::Clock, &Clock, "clock"},
+  {StateId::Locked, &Locked, "locked"},
+  {StateId::MenuTime, &MenuTime, "menu-time"},
+  {StateId::MenuSchedule, &MenuSchedule, "menu-schedule"},
+  {StateId::MenuNap, &MenuNap, "menu-nap"},
+  {StateId::MenuBrightness, &MenuBrightness, "menu-brightness"},
+  {StateId::MenuLock, &MenuLock, "menu-lock"},
+  {StateId::MenuBack, &MenuBack, "menu-back"},
+  {StateId::TimeSetHours, &TimeSetHours, "time-hours"},
+  {StateId::TimeSetMinutes, &TimeSetMinutes, "time-minutes"},
+  {StateId::ScheduleSetSleepHours, &ScheduleSetSleepHours, "sleep-hours"},
+  {StateId::ScheduleSetSleepMinutes, &ScheduleSetSleepMinutes, "sleep-minutes"},
+  {StateId::ScheduleSetQuietHours, &ScheduleSetQuietHours, "quiet-hours"},
+  {StateId::ScheduleSetQuietMinutes, &ScheduleSetQuietMinutes, "quiet-minutes"},
+  {StateId::NapSetDuration, &NapSetDuration, "nap-duration"},
+  {StateId::SetDisplayBrightness, &SetDisplayBrightness, "display-brightness"},
+  {StateId::SetColorBrightness, &SetColorBrightness, "color-brightness"},
+};
+
+constexpr bool statesInOrder() {
+  for (uint8_t i = 0; i < sizeof(STATES) / sizeof(STATES[0]); i++) {
+    if (STATES[i].id != static_cast<StateId>(i) || STATES[i].state == nullptr || STATES[i].name == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(sizeof(STATES) / sizeof(STATES[0]) == static_cast<uint8_t>(StateId::Count),
+              "every StateId needs a STATES entry");
+static_assert(statesInOrder(), "STATES must be listed in StateId order");
+
+} // namespace
+
+const State* StateMachine::currentState = nullptr;
+StateId StateMachine::currentStateId = StateId::Clock;
+ActionEvent StateMachine::currentEvent = {NONE, 0, 0};
+ActionEvent StateMachine::queue[StateMachine::QUEUE_SIZE];
+uint8_t StateMachine::queueHead = 0;
+uint8_t StateMachine::queueCount = 0;
+uint8_t StateMachine::maxQueueDepth = 0;
+uint32_t StateMachine::mergedEvents = 0;
+uint32_t StateMachine::droppedEvents = 0;
+uint32_t StateMachine::handledCount[ACTION_COUNT] = {0};
+uint64_t StateMachine::handleMicros[ACTION_COUNT] = {0};
+uint32_t StateMachine::maxHandleMicros[ACTION_COUNT] = {0};
+
+static const char* const ACTION_NAMES[ACTION_COUNT] = {
+  "none", "cw", "ccw", "select", "select_hold", "time_change"
+};
 
 void StateMachine::init() {
   if (Settings::isLocked()) {
-    setState(&Locked);
+    setState(StateId::Locked);
   } else {
-    setState(&Clock);
+    setState(StateId::Clock);
+  }
+}
+
+void StateMachine::setState(StateId newState) {
+  if (currentState != nullptr) {
+    EventLog::record(EventLog::STATE_CHANGE, static_cast<uint8_t>(currentStateId),
+                     static_cast<uint8_t>(newState));
+    if (currentState->onExit) {
+      PROFILE_STATE(currentStateId, Profiler::SLOT_ON_EXIT);
+      currentState->onExit();
+    }
+  }
+  currentStateId = newState;
+  currentState = STATES[static_cast<uint8_t>(newState)].state;
+  if (currentState->onEnter) {
+    PROFILE_STATE(newState, Profiler::SLOT_ON_ENTER);
+    currentState->onEnter();
+  }
+}
+
+StateId StateMachine::getState() {
+  return currentStateId;
+}
+
+const char* StateMachine::getStateName(StateId state) {
+  uint8_t index = static_cast<uint8_t>(state);
+  return (index < static_cast<uint8_t>(StateId::Count)) ? STATES[index].name : "?";
+}
+
+const char* StateMachine::getActionName(Action action) {
+  return (action < ACTION_COUNT) ? ACTION_NAMES[action] : "?";
+}
+
+void StateMachine::post(Action action) {
+  ActionEvent event = {action, 0, 0};
+  post(event);
+}
+
+void StateMachine::post(const ActionEvent& event) {
+  if (event.action == NONE || event.action >= ACTION_COUNT) return;
+
+  // One pending TIME_CHANGE covers any number of minute updates
+  if (event.action == TIME_CHANGE) {
+    for (uint8_t i = 0; i < queueCount; i++) {
+      if (queue[(queueHead + i) % QUEUE_SIZE].action == TIME_CHANGE) {
+        mergedEvents++;
+        return;
+      }
+    }
+  }
+
+  if (queueCount == QUEUE_SIZE) {
+    droppedEvents++;
+    LOG_ERROR("State machine queue full, dropping action %d", event.action);
+    return;
+  }
+  queue[(queueHead + queueCount) % QUEUE_SIZE] = event;
+  queueCount++;
+  if (queueCount > maxQueueDepth) {
+    maxQueueDepth = queueCount;
   }
 }
 
-void StateMachine::setState(State* newState) {
-  if (currentState != nullptr && currentState->OnExit) {
-    currentState->OnExit();
+// Run-to-completion: each event's handler returns before the next starts,
+// including events its own handler posted
+void StateMachine::dispatch() {
+  while (queueCount > 0) {
+    ActionEvent event = queue[queueHead];
+    queueHead = (queueHead + 1) % QUEUE_SIZE;
+    queueCount--;
+
+    unsigned long start = micros();
+    handle(event);
+    uint32_t elapsed = micros() - start;
+
+    handledCount[event.action]++;
+    handleMicros[event.action] += elapsed;
+    if (elapsed > maxHandleMicros[event.action]) {
+      maxHandleMicros[event.action] = elapsed;
+    }
   }
-  currentState = newState;
-  if (currentState->OnEnter) {
-    currentState->OnEnter();
+}
+
+// A rotation burst is handled once; value editors read its size through
+// rotationDetents()/rotationSteps() so they render and save only once.
+void StateMachine::handle(const ActionEvent& event) {
+  Action action = event.action;
+  if (currentState == nullptr) return;
+  currentEvent = event;
+  // Any user input dismisses a transient message straight away
+  if (action != TIME_CHANGE) Display::cancelMessage();
+  StateHandler handler = currentState->handlers[action];
+  if (handler) {
+    PROFILE_STATE(currentStateId, action);
+    handler();
   }
 }
 
-void StateMachine::processAction(Action action) {
-  if (currentState == nullptr || action == NONE) return;
-  if (action == CW && currentState->OnClockwise) currentState->OnClockwise();
-  if (action == CCW && currentState->OnCounterClockwise) currentState->OnCounterClockwise();
-  if (action == SELECT && currentState->OnSelect) currentState->OnSelect();
-  if (action == SELECT_HOLD && currentState->OnSelectHold) currentState->OnSelectHold();
-  if (action == TIME_CHANGE && currentState->OnTimeChange) currentState->OnTimeChange();
+uint16_t StateMachine::rotationDetents() {
+  int32_t delta = currentEvent.delta;
+  if (delta < 0) delta = -delta;
+  return (delta == 0) ? 1 : delta;
+}
+
+uint16_t StateMachine::rotationSteps() {
+  int32_t steps = Encoder::accelerate(rotationDetents(), currentEvent.velocity);
+  return (steps == 0) ? 1 : steps;
+}
+
+void StateMachine::logQueueStats() {
+  LOG_REPORT("State machine queue: max depth %u, %lu merged, %lu dropped",
+              maxQueueDepth, (unsigned long)mergedEvents, (unsigned long)droppedEvents);
+  for (uint8_t action = CW; action < ACTION_COUNT; action++) {
+    if (handledCount[action] == 0) continue;
+    LOG_REPORT("  %s: %lu handled, avg %lu us, max %lu us", ACTION_NAMES[action],
+                (unsigned long)handledCount[action],
+                (unsigned long)(handleMicros[action] / handledCount[action]),
+                (unsigned long)maxHandleMicros[action]);
+  }
 }
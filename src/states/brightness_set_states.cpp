@@ -10,73 +10,73 @@
 static uint8_t tempDisplayBrightness = 3;
 static uint8_t tempColorBrightness = 128;
 
-State SetDisplayBrightness = {
+constexpr State SetDisplayBrightness = defineState({
   .OnEnter = []() {
     tempDisplayBrightness = Settings::getDisplayBrightness();
-    Display::getInstance().print("DISP");
-    delay(1000);
+    Display::showMessage("DISP", MESSAGE_DURATION_MS);
     // Show current brightness level (0-15 mapped to 00-15)
-    String brightnessStr = (tempDisplayBrightness < 10) ? "0" + String(tempDisplayBrightness) : String(tempDisplayBrightness);
-    Display::getInstance().print(brightnessStr);
+    Display::print(DisplayText::level(tempDisplayBrightness));
+  },
+  .OnExit = []() {
+    Settings::flush();
+    Display::clear();
   },
-  .OnExit = []() { Display::getInstance().clear(); },
   .OnClockwise = []() { 
     if (tempDisplayBrightness < 15) {
-      tempDisplayBrightness++;
+      uint16_t detents = StateMachine::rotationDetents();
+      tempDisplayBrightness = (tempDisplayBrightness + detents > 15) ? 15 : tempDisplayBrightness + detents;
       Display::setBrightness(tempDisplayBrightness);
-      String brightnessStr = (tempDisplayBrightness < 10) ? "0" + String(tempDisplayBrightness) : String(tempDisplayBrightness);
-      Display::getInstance().print(brightnessStr);
+      Display::print(DisplayText::level(tempDisplayBrightness));
     }
   },
   .OnCounterClockwise = []() { 
     if (tempDisplayBrightness > 0) {
-      tempDisplayBrightness--;
+      uint16_t detents = StateMachine::rotationDetents();
+      tempDisplayBrightness = (tempDisplayBrightness < detents) ? 0 : tempDisplayBrightness - detents;
       Display::setBrightness(tempDisplayBrightness);
-      String brightnessStr = (tempDisplayBrightness < 10) ? "0" + String(tempDisplayBrightness) : String(tempDisplayBrightness);
-      Display::getInstance().print(brightnessStr);
+      Display::print(DisplayText::level(tempDisplayBrightness));
     }
   },
   .OnSelect = []() { 
     // Brightness is already saved in real-time, just move to color brightness
-    StateMachine::setState(&SetColorBrightness);
+    StateMachine::setState(StateId::SetColorBrightness);
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State SetColorBrightness = {
+constexpr State SetColorBrightness = defineState({
   .OnEnter = []() {
      // Convert to percentage, rounded down to nearest 5
     tempColorBrightness = (Settings::getLedBrightness() * 100 / 255) / 5 * 5;
-    Display::getInstance().print("LED");
-    delay(1000);
-    String brightnessStr = (tempColorBrightness < 10) ? "  " + String(tempColorBrightness) : (tempColorBrightness < 100) ? " " + String(tempColorBrightness) : String(tempColorBrightness);
-    Display::getInstance().print(brightnessStr + "%");
+    Display::showMessage("LED", MESSAGE_DURATION_MS);
+    Display::print(DisplayText::percent(tempColorBrightness));
     RgbLed::indicateStatus(WAKE);
   },
   .OnExit = []() { 
-    Display::getInstance().clear();
+    Settings::flush();
+    Display::clear();
   },
   .OnClockwise = []() { 
     if (tempColorBrightness < 100) {
-      tempColorBrightness = (tempColorBrightness + 5 > 100) ? 100 : tempColorBrightness + 5;
+      uint16_t increase = 5 * StateMachine::rotationDetents();
+      tempColorBrightness = (tempColorBrightness + increase > 100) ? 100 : tempColorBrightness + increase;
       RgbLed::setBrightness(tempColorBrightness * 255 / 100); // Convert back to 0-255
-      String brightnessStr = (tempColorBrightness < 10) ? "  " + String(tempColorBrightness) : (tempColorBrightness < 100) ? " " + String(tempColorBrightness) : String(tempColorBrightness);
-      Display::getInstance().print(brightnessStr + "%");
+      Display::print(DisplayText::percent(tempColorBrightness));
       RgbLed::indicateStatus(WAKE);
     }
   },
   .OnCounterClockwise = []() { 
     if (tempColorBrightness > 0) {
-      tempColorBrightness = (tempColorBrightness < 5) ? 0 : tempColorBrightness - 5;
+      uint16_t decrease = 5 * StateMachine::rotationDetents();
+      tempColorBrightness = (tempColorBrightness < decrease) ? 0 : tempColorBrightness - decrease;
       RgbLed::setBrightness(tempColorBrightness * 255 / 100);
-      String brightnessStr = (tempColorBrightness < 10) ? "  " + String(tempColorBrightness) : (tempColorBrightness < 100) ? " " + String(tempColorBrightness) : String(tempColorBrightness);
-      Display::getInstance().print(brightnessStr + "%");
+      Display::print(DisplayText::percent(tempColorBrightness));
       RgbLed::indicateStatus(WAKE);
     }
   },
   .OnSelect = []() { 
     Clock::updateScheduleLED();
-    StateMachine::setState(&Clock);
+    StateMachine::setState(StateId::Clock);
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
@@ -3,19 +3,17 @@
 #include "clock.h"
 #include "state_machine.h"
 
-State Clock = {
+constexpr State Clock = defineState({
   .OnEnter = []() {
-    Display::getInstance().print(Clock::getTimeString());
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(Clock::getTimeString());
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().colonOff(); Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuTime); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuTime); },
-  .OnSelect = []() { StateMachine::setState(&MenuTime); },
+  .OnExit = []() { Display::setColon(false); Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(StateId::MenuTime); },
+  .OnCounterClockwise = []() { StateMachine::setState(StateId::MenuTime); },
+  .OnSelect = []() { StateMachine::setState(StateId::MenuTime); },
   .OnTimeChange = []() {
-    Display::getInstance().print(Clock::getTimeString());
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(Clock::getTimeString());
+    Display::setColon(true);
   }
-};
\ No newline at end of file
+});
\ No newline at end of file
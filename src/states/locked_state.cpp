@@ -5,38 +5,27 @@
 #include "settings.h"
 #include "logging.h"
 
+// The time stays in the framebuffer underneath and comes back on its own
 void showLockMessage() {
-  String currentDisplay = Clock::getTimeString();
-  Display::getInstance().clear();
-  Display::getInstance().print("LOCK");
-  delay(1000);
-  Display::getInstance().clear();
-  Display::getInstance().print(currentDisplay);
-  delay(10);
-  Display::getInstance().colonOn();
+  Display::showMessage("LOCK", MESSAGE_DURATION_MS);
 }
 
-State Locked = {
+constexpr State Locked = defineState({
   .OnEnter = []() {
-    Display::getInstance().print(Clock::getTimeString());
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(Clock::getTimeString());
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().colonOff(); Display::getInstance().clear(); },
+  .OnExit = []() { Display::setColon(false); Display::clear(); },
   .OnClockwise = []() { showLockMessage(); },
   .OnCounterClockwise = []() { showLockMessage(); },
   .OnSelect = []() { showLockMessage(); },
   .OnSelectHold = []() {
     Settings::setLocked(false);
-    Display::getInstance().clear();
-    Display::getInstance().print("UNLK");
-    delay(1000);
-    Settings::setLocked(false);
-    StateMachine::setState(&Clock);
+    Display::showMessage("UNLK", MESSAGE_DURATION_MS);
+    StateMachine::setState(StateId::Clock);
   },
   .OnTimeChange = []() {
-    Display::getInstance().print(Clock::getTimeString());
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(Clock::getTimeString());
+    Display::setColon(true);
   }
-};
\ No newline at end of file
+});
\ No newline at end of file
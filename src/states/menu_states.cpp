@@ -5,79 +5,115 @@
 #include "settings.h"
 #include "logging.h"
 
-State MenuTime = {
-  .OnEnter = []() { Display::getInstance().print("TIME"); },
-  .OnExit = []() { Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuSchedule); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuLock); },
-  .OnSelect = []() { StateMachine::setState(&TimeSetHours); },
-  .OnSelectHold = []() { /* Do nothing */ }
+#define LOG_MODULE LOG_INPUT
+
+// Top-level menu, in dial order; turning past either end wraps around
+constexpr StateId MENU_RING[] = {
+  StateId::MenuTime,
+  StateId::MenuSchedule,
+  StateId::MenuNap,
+  StateId::MenuBrightness,
+  StateId::MenuLock,
+  StateId::MenuBack,
 };
+constexpr int MENU_RING_SIZE = sizeof(MENU_RING) / sizeof(MENU_RING[0]);
+
+constexpr StateId menuStep(StateId from, int step) {
+  for (int i = 0; i < MENU_RING_SIZE; i++) {
+    if (MENU_RING[i] == from) {
+      return MENU_RING[wrapStep(i, step, MENU_RING_SIZE)];
+    }
+  }
+  return from;
+}
+
+// Walking the ring one way visits every entry once and comes back to the start
+constexpr bool menuRingIsClosed() {
+  StateId id = MENU_RING[0];
+  for (int i = 0; i < MENU_RING_SIZE; i++) {
+    if (MENU_RING[i] != id || menuStep(menuStep(id, 1), -1) != id) {
+      return false;
+    }
+    id = menuStep(id, 1);
+  }
+  return id == MENU_RING[0];
+}
+
+static_assert(menuRingIsClosed(), "menu ring entries must be unique");
 
-State MenuSchedule = {
-  .OnEnter = []() { Display::getInstance().print("SCHD"); },
-  .OnExit = []() { Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuNap); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuTime); },
+constexpr State MenuTime = defineState({
+  .OnEnter = []() { Display::print("TIME"); },
+  .OnExit = []() { Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(menuStep(StateId::MenuTime, 1)); },
+  .OnCounterClockwise = []() { StateMachine::setState(menuStep(StateId::MenuTime, -1)); },
+  .OnSelect = []() { StateMachine::setState(StateId::TimeSetHours); },
+  .OnSelectHold = []() { /* Do nothing */ }
+});
+
+constexpr State MenuSchedule = defineState({
+  .OnEnter = []() { Display::print("SCHD"); },
+  .OnExit = []() { Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(menuStep(StateId::MenuSchedule, 1)); },
+  .OnCounterClockwise = []() { StateMachine::setState(menuStep(StateId::MenuSchedule, -1)); },
   .OnSelect = []() { 
-    StateMachine::setState(&ScheduleSetSleepHours); 
+    StateMachine::setState(StateId::ScheduleSetSleepHours); 
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State MenuNap = {
+constexpr State MenuNap = defineState({
   .OnEnter = []() { 
     // Check if nap is currently active
     if (Settings::isNapEnabled()) {
-      Display::getInstance().print("STOP");
+      Display::print("STOP");
     } else {
-      Display::getInstance().print("NAP");
+      Display::print("NAP");
     }
   },
-  .OnExit = []() { Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuBrightness); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuSchedule); },
+  .OnExit = []() { Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(menuStep(StateId::MenuNap, 1)); },
+  .OnCounterClockwise = []() { StateMachine::setState(menuStep(StateId::MenuNap, -1)); },
   .OnSelect = []() { 
     if (Settings::isNapEnabled()) {
       Settings::stopNap();
       Clock::updateScheduleLED();
-      Log::info("Nap stopped by user");
-      StateMachine::setState(&Clock);
+      LOG_INFO("Nap stopped by user");
+      StateMachine::setState(StateId::Clock);
     } else {
-      StateMachine::setState(&NapSetDuration);
+      StateMachine::setState(StateId::NapSetDuration);
     }
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State MenuBrightness = {
-  .OnEnter = []() { Display::getInstance().print("BRGT"); },
-  .OnExit = []() { Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuLock); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuNap); },
-  .OnSelect = []() { StateMachine::setState(&SetDisplayBrightness); },
+constexpr State MenuBrightness = defineState({
+  .OnEnter = []() { Display::print("BRGT"); },
+  .OnExit = []() { Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(menuStep(StateId::MenuBrightness, 1)); },
+  .OnCounterClockwise = []() { StateMachine::setState(menuStep(StateId::MenuBrightness, -1)); },
+  .OnSelect = []() { StateMachine::setState(StateId::SetDisplayBrightness); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State MenuLock = {
+constexpr State MenuLock = defineState({
   .OnEnter = []() { 
-    Display::getInstance().print("LOCK");
+    Display::print("LOCK");
   },
-  .OnExit = []() { Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuBack); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuBrightness); },
+  .OnExit = []() { Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(menuStep(StateId::MenuLock, 1)); },
+  .OnCounterClockwise = []() { StateMachine::setState(menuStep(StateId::MenuLock, -1)); },
   .OnSelect = []() { 
     Settings::setLocked(true);
-    StateMachine::setState(&Locked);
+    StateMachine::setState(StateId::Locked);
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State MenuBack = {
-  .OnEnter = []() { Display::getInstance().print("BACK"); },
-  .OnExit = []() { Display::getInstance().clear(); },
-  .OnClockwise = []() { StateMachine::setState(&MenuTime); },
-  .OnCounterClockwise = []() { StateMachine::setState(&MenuLock); },
-  .OnSelect = []() { StateMachine::setState(&Clock); },
+constexpr State MenuBack = defineState({
+  .OnEnter = []() { Display::print("BACK"); },
+  .OnExit = []() { Display::clear(); },
+  .OnClockwise = []() { StateMachine::setState(menuStep(StateId::MenuBack, 1)); },
+  .OnCounterClockwise = []() { StateMachine::setState(menuStep(StateId::MenuBack, -1)); },
+  .OnSelect = []() { StateMachine::setState(StateId::Clock); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
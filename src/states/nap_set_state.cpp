@@ -5,39 +5,37 @@
 #include "settings.h"
 #include "logging.h"
 
+#define LOG_MODULE LOG_INPUT
+
 static uint16_t tempNapDuration = 60; // Default 60 minutes
 
-State NapSetDuration = {
+constexpr State NapSetDuration = defineState({
   .OnEnter = []() {
     tempNapDuration = 60;
-    Display::getInstance().print(String(tempNapDuration));
-    delay(10);
-    Display::getInstance().colonOff();
+    Display::print(DisplayText::napMinutes(tempNapDuration));
+    Display::setColon(false);
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
-    // Increment duration by 5 minutes, max 300 (5 hours)
-    tempNapDuration += 5;
-    if (tempNapDuration > 300) {
-      tempNapDuration = 300;
-    }
-    Display::getInstance().print(String(tempNapDuration));
+    // Increment duration by 5 minutes per step, max 300 (5 hours)
+    uint16_t increase = 5 * StateMachine::rotationSteps();
+    tempNapDuration = (tempNapDuration + increase > 300) ? 300 : tempNapDuration + increase;
+    Display::print(DisplayText::napMinutes(tempNapDuration));
   },
   .OnCounterClockwise = []() { 
-    // Decrement duration by 5 minutes, min 5
-    if (tempNapDuration > 5) {
-      tempNapDuration -= 5;
-    }
-    Display::getInstance().print(String(tempNapDuration));
+    // Decrement duration by 5 minutes per step, min 5
+    uint16_t decrease = 5 * StateMachine::rotationSteps();
+    tempNapDuration = (tempNapDuration < 5 + decrease) ? 5 : tempNapDuration - decrease;
+    Display::print(DisplayText::napMinutes(tempNapDuration));
   },
   .OnSelect = []() { 
     // Start the nap with the selected duration
     if (Clock::startNap(tempNapDuration)) {
-      Log::info("Nap started with duration %d minutes", tempNapDuration);
+      LOG_INFO("Nap started with duration %d minutes", tempNapDuration);
     } else {
-      Log::error("Failed to start nap");
+      LOG_ERROR("Failed to start nap");
     }
-    StateMachine::setState(&Clock); 
+    StateMachine::setState(StateId::Clock); 
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
\ No newline at end of file
+});
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "settings.h"
 #include "logging.h"
 
+#define LOG_MODULE LOG_INPUT
+
 static uint8_t tempSleepStartHour = 22;
 static uint8_t tempSleepStartMinute = 0;
 static uint8_t tempQuietStartHour = 23;
@@ -46,10 +48,10 @@ void saveCompleteSchedule() {
     allSchedules[i] = schedule;
   }
   Settings::saveAllSchedules(allSchedules);
-  Log::info("Schedule saved to all days of the week");
+  LOG_INFO("Schedule saved to all days of the week");
 }
 
-State ScheduleSetSleepHours = {
+constexpr State ScheduleSetSleepHours = defineState({
   .OnEnter = []() {
     Schedule currentSchedule;
     currentScheduleDay = SUNDAY;
@@ -60,118 +62,80 @@ State ScheduleSetSleepHours = {
     tempQuietStartHour = currentSchedule.getQuietStartHour();
     tempQuietStartMinute = currentSchedule.getQuietStartMinute();
     
-    Display::getInstance().print("STRT");
-    delay(10);
-    Display::getInstance().colonOff();
-    delay(1000);
-    String AMPM = tempSleepStartHour < 12 ? "AM" : "PM";
-    uint8_t displayHour = tempSleepStartHour;
-    if (displayHour == 0) displayHour = 12;
-    else displayHour = displayHour % 12;
-    Display::getInstance().print((displayHour < 10 ? "0" : "") + String(displayHour) + AMPM);
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::showMessage("STRT", MESSAGE_DURATION_MS);
+    Display::print(DisplayText::hourWithMeridiem(tempSleepStartHour, '0'));
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
-    tempSleepStartHour = (tempSleepStartHour + 1) % 24;
-    String AMPM = tempSleepStartHour < 12 ? "AM" : "PM";
-    uint8_t displayHour = tempSleepStartHour;
-    if (displayHour == 0) displayHour = 12;
-    else displayHour = displayHour % 12;
-    Display::getInstance().print((displayHour < 10 ? "0" : "") + String(displayHour) + AMPM);
+    tempSleepStartHour = wrapStep(tempSleepStartHour, StateMachine::rotationDetents(), 24);
+    Display::print(DisplayText::hourWithMeridiem(tempSleepStartHour, '0'));
   },
   .OnCounterClockwise = []() { 
-    tempSleepStartHour = (tempSleepStartHour == 0) ? 23 : tempSleepStartHour - 1;
-    String AMPM = tempSleepStartHour < 12 ? "AM" : "PM";
-    uint8_t displayHour = tempSleepStartHour;
-    if (displayHour == 0) displayHour = 12;
-    else displayHour = displayHour % 12;
-    Display::getInstance().print((displayHour < 10 ? "0" : "") + String(displayHour) + AMPM);
+    tempSleepStartHour = wrapStep(tempSleepStartHour, -StateMachine::rotationDetents(), 24);
+    Display::print(DisplayText::hourWithMeridiem(tempSleepStartHour, '0'));
   },
-  .OnSelect = []() { StateMachine::setState(&ScheduleSetSleepMinutes); },
+  .OnSelect = []() { StateMachine::setState(StateId::ScheduleSetSleepMinutes); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State ScheduleSetSleepMinutes = {
+constexpr State ScheduleSetSleepMinutes = defineState({
   .OnEnter = []() {
-    String minuteStr = (tempSleepStartMinute < 10) ? "0" + String(tempSleepStartMinute) : String(tempSleepStartMinute);
-    Display::getInstance().print("M " + minuteStr);
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(DisplayText::minutes(tempSleepStartMinute));
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
-    tempSleepStartMinute = (tempSleepStartMinute + 1) % 60;
-    String minuteStr = (tempSleepStartMinute < 10) ? "0" + String(tempSleepStartMinute) : String(tempSleepStartMinute);
-    Display::getInstance().print("M " + minuteStr);
+    tempSleepStartMinute = wrapStep(tempSleepStartMinute, StateMachine::rotationSteps(), 60);
+    Display::print(DisplayText::minutes(tempSleepStartMinute));
   },
   .OnCounterClockwise = []() { 
-    tempSleepStartMinute = (tempSleepStartMinute == 0) ? 59 : tempSleepStartMinute - 1;
-    String minuteStr = (tempSleepStartMinute < 10) ? "0" + String(tempSleepStartMinute) : String(tempSleepStartMinute);
-    Display::getInstance().print("M " + minuteStr);
+    tempSleepStartMinute = wrapStep(tempSleepStartMinute, -StateMachine::rotationSteps(), 60);
+    Display::print(DisplayText::minutes(tempSleepStartMinute));
   },
-  .OnSelect = []() { StateMachine::setState(&ScheduleSetQuietHours); },
+  .OnSelect = []() { StateMachine::setState(StateId::ScheduleSetQuietHours); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State ScheduleSetQuietHours = {
+constexpr State ScheduleSetQuietHours = defineState({
   .OnEnter = []() {
-    Display::getInstance().print("STOP");
-    delay(10);
-    Display::getInstance().colonOff();
-    delay(1000);
-    String AMPM = tempQuietStartHour < 12 ? "AM" : "PM";
-    uint8_t displayHour = tempQuietStartHour;
-    if (displayHour == 0) displayHour = 12;
-    else displayHour = displayHour % 12;
-    Display::getInstance().print((displayHour < 10 ? "0" : "") + String(displayHour) + AMPM);
+    Display::showMessage("STOP", MESSAGE_DURATION_MS);
+    Display::setColon(false);
+    Display::print(DisplayText::hourWithMeridiem(tempQuietStartHour, '0'));
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
-    tempQuietStartHour = (tempQuietStartHour + 1) % 24;
-    String AMPM = tempQuietStartHour < 12 ? "AM" : "PM";
-    uint8_t displayHour = tempQuietStartHour;
-    if (displayHour == 0) displayHour = 12;
-    else displayHour = displayHour % 12;
-    Display::getInstance().print((displayHour < 10 ? "0" : "") + String(displayHour) + AMPM);
+    tempQuietStartHour = wrapStep(tempQuietStartHour, StateMachine::rotationDetents(), 24);
+    Display::print(DisplayText::hourWithMeridiem(tempQuietStartHour, '0'));
   },
   .OnCounterClockwise = []() { 
-    tempQuietStartHour = (tempQuietStartHour == 0) ? 23 : tempQuietStartHour - 1;
-    String AMPM = tempQuietStartHour < 12 ? "AM" : "PM";
-    uint8_t displayHour = tempQuietStartHour;
-    if (displayHour == 0) displayHour = 12;
-    else displayHour = displayHour % 12;
-    Display::getInstance().print((displayHour < 10 ? "0" : "") + String(displayHour) + AMPM);
+    tempQuietStartHour = wrapStep(tempQuietStartHour, -StateMachine::rotationDetents(), 24);
+    Display::print(DisplayText::hourWithMeridiem(tempQuietStartHour, '0'));
   },
-  .OnSelect = []() { StateMachine::setState(&ScheduleSetQuietMinutes); },
+  .OnSelect = []() { StateMachine::setState(StateId::ScheduleSetQuietMinutes); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State ScheduleSetQuietMinutes = {
+constexpr State ScheduleSetQuietMinutes = defineState({
   .OnEnter = []() {
-    String minuteStr = (tempQuietStartMinute < 10) ? "0" + String(tempQuietStartMinute) : String(tempQuietStartMinute);
-    Display::getInstance().print("M " + minuteStr);
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(DisplayText::minutes(tempQuietStartMinute));
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
-    tempQuietStartMinute = (tempQuietStartMinute + 1) % 60;
-    String minuteStr = (tempQuietStartMinute < 10) ? "0" + String(tempQuietStartMinute) : String(tempQuietStartMinute);
-    Display::getInstance().print("M " + minuteStr);
+    tempQuietStartMinute = wrapStep(tempQuietStartMinute, StateMachine::rotationSteps(), 60);
+    Display::print(DisplayText::minutes(tempQuietStartMinute));
   },
   .OnCounterClockwise = []() { 
-    tempQuietStartMinute = (tempQuietStartMinute == 0) ? 59 : tempQuietStartMinute - 1;
-    String minuteStr = (tempQuietStartMinute < 10) ? "0" + String(tempQuietStartMinute) : String(tempQuietStartMinute);
-    Display::getInstance().print("M " + minuteStr);
+    tempQuietStartMinute = wrapStep(tempQuietStartMinute, -StateMachine::rotationSteps(), 60);
+    Display::print(DisplayText::minutes(tempQuietStartMinute));
   },
   .OnSelect = []() { 
     // Save the complete schedule with calculated values
     saveCompleteSchedule();
     // Update the RGB LED based on the new schedule
     Clock::updateScheduleLED();
-    StateMachine::setState(&Clock); 
+    StateMachine::setState(StateId::Clock); 
   },
   .OnSelectHold = []() { /* Do nothing */ }
-};
\ No newline at end of file
+});
\ No newline at end of file
@@ -5,68 +5,62 @@
 #include "settings.h"
 #include "logging.h"
 
-State TimeSetHours = {
+constexpr State TimeSetHours = defineState({
   .OnEnter = []() {
-    uint8_t currentHours = Clock::getCurrentHours();
-    String AMPM = currentHours < 12 ? "AM" : "PM";
-    Display::getInstance().print(Clock::getTimeString().substring(0, 2) + AMPM);
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(DisplayText::hourWithMeridiem(Clock::getCurrentHours(), ' '));
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
     uint8_t currentHours = Clock::getCurrentHours();
     uint8_t currentMinutes = Clock::getCurrentMinutes();
     
     // Increment hours (24-hour format, wraps from 23 to 0)
-    currentHours = (currentHours + 1) % 24;
+    currentHours = wrapStep(currentHours, StateMachine::rotationDetents(), 24);
     
     Clock::setTime(currentHours, currentMinutes, 0);
-    String AMPM = currentHours < 12 ? "AM" : "PM";
-    Display::getInstance().print(Clock::getTimeString().substring(0, 2) + AMPM);
+    Display::print(DisplayText::hourWithMeridiem(currentHours, ' '));
   },
   .OnCounterClockwise = []() { 
     uint8_t currentHours = Clock::getCurrentHours();
     uint8_t currentMinutes = Clock::getCurrentMinutes();
     
     // Decrement hours (24-hour format, wraps from 0 to 23)
-    currentHours = (currentHours == 0) ? 23 : currentHours - 1;
+    currentHours = wrapStep(currentHours, -StateMachine::rotationDetents(), 24);
     
     Clock::setTime(currentHours, currentMinutes, 0);
-    String AMPM = currentHours < 12 ? "AM" : "PM";
-    Display::getInstance().print(Clock::getTimeString().substring(0, 2) + AMPM);
+    Display::print(DisplayText::hourWithMeridiem(currentHours, ' '));
   },
-  .OnSelect = []() { StateMachine::setState(&TimeSetMinutes); },
+  .OnSelect = []() { StateMachine::setState(StateId::TimeSetMinutes); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
+});
 
-State TimeSetMinutes = {
+constexpr State TimeSetMinutes = defineState({
   .OnEnter = []() {
-    Display::getInstance().print("M " + Clock::getTimeString().substring(2));
-    delay(10);
-    Display::getInstance().colonOn();
+    Display::print(DisplayText::minutes(Clock::getCurrentMinutes()));
+    Display::setColon(true);
   },
-  .OnExit = []() { Display::getInstance().clear(); },
+  .OnExit = []() { Display::clear(); },
   .OnClockwise = []() { 
     uint8_t currentHours = Clock::getCurrentHours();
     uint8_t currentMinutes = Clock::getCurrentMinutes();
     
     // Increment minutes (wraps from 59 to 0)
-    currentMinutes = (currentMinutes + 1) % 60;
+    currentMinutes = wrapStep(currentMinutes, StateMachine::rotationSteps(), 60);
     
     Clock::setTime(currentHours, currentMinutes, 0);
-    Display::getInstance().print("M " + Clock::getTimeString().substring(2));
+    Display::print(DisplayText::minutes(Clock::getCurrentMinutes()));
   },
   .OnCounterClockwise = []() { 
     uint8_t currentHours = Clock::getCurrentHours();
     uint8_t currentMinutes = Clock::getCurrentMinutes();
     
     // Decrement minutes (wraps from 0 to 59)
-    currentMinutes = (currentMinutes == 0) ? 59 : currentMinutes - 1;
+    currentMinutes = wrapStep(currentMinutes, -StateMachine::rotationSteps(), 60);
     
     Clock::setTime(currentHours, currentMinutes, 0);
-    Display::getInstance().print("M " + Clock::getTimeString().substring(2));
+    Display::print(DisplayText::minutes(Clock::getCurrentMinutes()));
   },
-  .OnSelect = []() { StateMachine::setState(&Clock); },
+  .OnSelect = []() { StateMachine::setState(StateId::Clock); },
   .OnSelectHold = []() { /* Do nothing */ }
-};
\ No newline at end of file
+});
\ No newline at end of file
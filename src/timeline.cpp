@@ -0,0 +1,122 @@
+#include "timeline.h"
+#include "clock.h"
+#include "settings.h"
+#include "rgbled.h"
+#include "event_log.h"
+#include "logging.h"
+
+#define LOG_MODULE LOG_CLOCK
+
+// Static member definitions
+ScheduleBlock Timeline::currentBlock = NO_BLOCK;
+ScheduleBlock Timeline::nextBlock = NO_BLOCK;
+uint16_t Timeline::nextTransition = 0;
+uint16_t Timeline::lastMinute = 0;
+uint16_t Timeline::minutesRemaining = 0;
+
+void Timeline::rebuild() {
+    Schedule week[7];
+    Settings::loadAllSchedules(week);
+
+    uint16_t now = currentMinuteOfWeek();
+
+    // Naps take priority over the daily schedule until they run out
+    Schedule napSchedule;
+    bool hasActiveNap = Settings::isNapEnabled() && Settings::loadNapSchedule(napSchedule);
+    if (hasActiveNap && napSchedule.getBlockAt(now % MINUTES_PER_DAY) == NO_BLOCK) {
+        LOG_INFO("Nap period ended, deactivating nap");
+        Settings::stopNap();
+        hasActiveNap = false;
+    }
+
+    ScheduleBlock previousBlock = currentBlock;
+    currentBlock = compute(week, hasActiveNap ? &napSchedule : nullptr, now, nextTransition, nextBlock);
+    if (currentBlock != previousBlock) {
+        EventLog::record(EventLog::SCHEDULE_CHANGE, previousBlock, currentBlock, now);
+    }
+    lastMinute = now;
+    minutesRemaining = (nextTransition + MINUTES_PER_WEEK - now) % MINUTES_PER_WEEK;
+    if (minutesRemaining == 0) {
+        // Same block all week; look again in a week
+        minutesRemaining = MINUTES_PER_WEEK;
+    }
+
+    LOG_INFO("%s schedule: current block = %d, next block %d in %u minutes",
+              hasActiveNap ? "Nap" : "Daily", currentBlock, nextBlock, minutesRemaining);
+
+    RgbLed::indicateStatus(currentBlock);
+}
+
+void Timeline::onMinute() {
+    uint16_t now = currentMinuteOfWeek();
+    // A backwards step shows up as almost a full week elapsed and rebuilds
+    uint16_t elapsed = (now + MINUTES_PER_WEEK - lastMinute) % MINUTES_PER_WEEK;
+    lastMinute = now;
+
+    if (elapsed < minutesRemaining) {
+        minutesRemaining -= elapsed;
+        return;
+    }
+    rebuild();
+}
+
+ScheduleBlock Timeline::getCurrentBlock() {
+    return currentBlock;
+}
+
+uint16_t Timeline::currentMinuteOfWeek() {
+    const Clock::Snapshot& now = Clock::getSnapshot();
+    return (now.dayOfWeek % 7) * MINUTES_PER_DAY + now.hours * 60 + now.minutes;
+}
+
+ScheduleBlock Timeline::blockAt(const Schedule week[7], const Schedule* nap, uint16_t minuteOfWeek) {
+    uint16_t minuteOfDay = minuteOfWeek % MINUTES_PER_DAY;
+    if (nap != nullptr) {
+        ScheduleBlock napBlock = nap->getBlockAt(minuteOfDay);
+        if (napBlock != NO_BLOCK) {
+            return napBlock;
+        }
+    }
+    return week[minuteOfWeek / MINUTES_PER_DAY].getBlockAt(minuteOfDay);
+}
+
+// Blocks only change at a schedule boundary or at midnight (when the next
+// day's schedule takes over), so only those minutes need to be checked.
+ScheduleBlock Timeline::compute(const Schedule week[7], const Schedule* nap, uint16_t minuteOfWeek,
+                                uint16_t& transition, ScheduleBlock& transitionBlock) {
+    ScheduleBlock block = blockAt(week, nap, minuteOfWeek);
+    uint16_t today = minuteOfWeek / MINUTES_PER_DAY;
+    uint16_t bestOffset = 0;
+    transition = minuteOfWeek;
+    transitionBlock = block;
+
+    auto consider = [&](uint32_t candidate) {
+        uint16_t offset = (candidate + MINUTES_PER_WEEK - minuteOfWeek) % MINUTES_PER_WEEK;
+        if (offset == 0 || (bestOffset != 0 && offset >= bestOffset)) {
+            return;
+        }
+        uint16_t minute = (minuteOfWeek + offset) % MINUTES_PER_WEEK;
+        ScheduleBlock candidateBlock = blockAt(week, nap, minute);
+        if (candidateBlock != block) {
+            bestOffset = offset;
+            transition = minute;
+            transitionBlock = candidateBlock;
+        }
+    };
+
+    for (uint16_t d = 0; d <= 7; d++) {
+        uint16_t day = (today + d) % 7;
+        uint32_t dayStart = (uint32_t)day * MINUTES_PER_DAY;
+        consider(dayStart);
+        for (uint16_t boundary : week[day].getBoundaries()) {
+            consider(dayStart + boundary % MINUTES_PER_DAY);
+        }
+        if (nap != nullptr && d <= 1) {
+            for (uint16_t boundary : nap->getBoundaries()) {
+                consider(dayStart + boundary % MINUTES_PER_DAY);
+            }
+        }
+    }
+
+    return block;
+}
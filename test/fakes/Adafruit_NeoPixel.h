@@ -0,0 +1,52 @@
+#ifndef FAKE_ADAFRUIT_NEOPIXEL_H
+#define FAKE_ADAFRUIT_NEOPIXEL_H
+
+// Pixel buffer that records what was shown. showCostUs is added to the fake
+// clock by every show(), to stand in for the time on the wire.
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+    static constexpr uint16_t MAX_PIXELS = 64;
+
+    uint32_t showCount = 0;
+    uint32_t shownColor[MAX_PIXELS] = {};
+    int64_t showCostUs = 0;
+
+    Adafruit_NeoPixel(uint16_t count, int16_t, uint16_t) : count(std::min(count, MAX_PIXELS)) {}
+
+    void begin() {}
+
+    void show() {
+        memcpy(shownColor, color, sizeof(color));
+        showCount++;
+        fake::nowUs += showCostUs;
+    }
+
+    void fill(uint32_t value = 0, uint16_t first = 0, uint16_t length = 0) {
+        uint16_t end = (length == 0) ? count : std::min<uint16_t>(count, first + length);
+        for (uint16_t i = first; i < end; i++) {
+            color[i] = value;
+        }
+    }
+
+    void setPixelColor(uint16_t index, uint32_t value) {
+        if (index < count) {
+            color[index] = value;
+        }
+    }
+
+    static uint32_t Color(uint8_t red, uint8_t green, uint8_t blue) {
+        return ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue;
+    }
+
+private:
+    uint16_t count;
+    uint32_t color[MAX_PIXELS] = {};
+};
+
+#endif // FAKE_ADAFRUIT_NEOPIXEL_H
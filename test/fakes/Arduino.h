@@ -0,0 +1,81 @@
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+// The parts of the Arduino core the firmware uses, backed by fake_platform.h.
+// Like the real core, it pulls in the standard headers the firmware relies on.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <string>
+#include "fake_platform.h"
+
+#define IRAM_ATTR
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+inline unsigned long millis() { return (unsigned long)(fake::nowUs / 1000); }
+inline unsigned long micros() { return (unsigned long)fake::nowUs; }
+inline void delay(unsigned long ms) { fake::advanceMs(ms); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t pin) { return fake::pinLevel[pin]; }
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t pin, void (*handler)(), int) { fake::pinInterrupt[pin] = handler; }
+inline void detachInterrupt(uint8_t pin) { fake::pinInterrupt[pin] = nullptr; }
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            write(data[i]);
+        }
+        return length;
+    }
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t println(const char* text) { return print(text) + print("\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return write((const uint8_t*)buffer, std::min((size_t)length, sizeof(buffer) - 1));
+    }
+};
+
+// Output is kept only while a test is recording it
+class HardwareSerial : public Print {
+public:
+    std::string output;
+    bool recording = false;
+
+    using Print::write;
+    size_t write(uint8_t c) override {
+        if (recording) {
+            output += (char)c;
+        }
+        return 1;
+    }
+    void begin(unsigned long) {}
+    void flush() {}
+};
+
+inline HardwareSerial Serial;
+
+#endif // FAKE_ARDUINO_H
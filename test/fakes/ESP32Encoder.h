@@ -0,0 +1,16 @@
+#ifndef FAKE_ESP32ENCODER_H
+#define FAKE_ESP32ENCODER_H
+
+#include <stdint.h>
+
+// PCNT-backed counter; tests move count directly
+class ESP32Encoder {
+public:
+    int64_t count = 0;
+
+    void attachSingleEdge(int, int) {}
+    void setCount(int64_t value) { count = value; }
+    int64_t getCount() { return count; }
+};
+
+#endif // FAKE_ESP32ENCODER_H
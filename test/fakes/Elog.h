@@ -0,0 +1,64 @@
+#ifndef FAKE_ELOG_H
+#define FAKE_ELOG_H
+
+// Elog's logger, writing one line per message to the registered stream
+
+#include <Arduino.h>
+
+#define ELOG_LEVEL_ERROR 3
+#define ELOG_LEVEL_WARNING 4
+#define ELOG_LEVEL_NOTICE 5
+#define ELOG_LEVEL_INFO 6
+#define ELOG_LEVEL_DEBUG 7
+
+class Elog {
+public:
+    void configure(int, bool) {}
+    void registerSerial(uint8_t, uint8_t, const char*, Print& stream) { out = &stream; }
+
+    void error(uint8_t, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+        va_list args;
+        va_start(args, format);
+        log("ERROR", format, args);
+        va_end(args);
+    }
+    void warning(uint8_t, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+        va_list args;
+        va_start(args, format);
+        log("WARN", format, args);
+        va_end(args);
+    }
+    void notice(uint8_t, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+        va_list args;
+        va_start(args, format);
+        log("NOTICE", format, args);
+        va_end(args);
+    }
+    void info(uint8_t, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+        va_list args;
+        va_start(args, format);
+        log("INFO", format, args);
+        va_end(args);
+    }
+    void debug(uint8_t, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+        va_list args;
+        va_start(args, format);
+        log("DEBUG", format, args);
+        va_end(args);
+    }
+
+private:
+    Print* out = nullptr;
+
+    void log(const char* level, const char* format, va_list args) {
+        if (out != nullptr) {
+            char buffer[256];
+            vsnprintf(buffer, sizeof(buffer), format, args);
+            out->printf("%s: %s\n", level, buffer);
+        }
+    }
+};
+
+inline Elog Logger;
+
+#endif // FAKE_ELOG_H
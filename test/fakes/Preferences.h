@@ -0,0 +1,49 @@
+#ifndef FAKE_PREFERENCES_H
+#define FAKE_PREFERENCES_H
+
+// NVS namespace kept in memory. One store is shared by every instance, so
+// data survives end() and begin() the way flash does.
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    static std::map<std::string, std::vector<uint8_t>>& store() {
+        static std::map<std::string, std::vector<uint8_t>> values;
+        return values;
+    }
+
+    bool begin(const char*, bool) { return true; }
+    void end() {}
+
+    bool remove(const char* key) { return store().erase(key) > 0; }
+
+    size_t putBytes(const char* key, const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        store()[key].assign(bytes, bytes + length);
+        return length;
+    }
+
+    size_t getBytes(const char* key, void* data, size_t length) {
+        auto entry = store().find(key);
+        if (entry == store().end() || entry->second.size() > length) {
+            return 0;
+        }
+        memcpy(data, entry->second.data(), entry->second.size());
+        return entry->second.size();
+    }
+
+    size_t putBool(const char* key, bool value) { return putUChar(key, value); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue) != 0; }
+
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, 1); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) {
+        uint8_t value;
+        return getBytes(key, &value, 1) == 1 ? value : defaultValue;
+    }
+};
+
+#endif // FAKE_PREFERENCES_H
@@ -0,0 +1,115 @@
+#ifndef FAKE_WIRE_H
+#define FAKE_WIRE_H
+
+// I2C master with pluggable device models. Addresses with no device NACK.
+// Every transaction that ends in a STOP condition is counted, so a
+// write/repeated-start/read pair counts once.
+
+#include <Arduino.h>
+
+namespace fake {
+
+class I2cDevice {
+public:
+    virtual ~I2cDevice() = default;
+    // Bytes written in one transmission; false NACKs the address
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+    // Fill a read request; false NACKs the address
+    virtual bool read(uint8_t* data, size_t length) = 0;
+};
+
+} // namespace fake
+
+class TwoWire {
+public:
+    static constexpr size_t BUFFER_SIZE = 1024;
+
+    uint32_t transactions = 0; // Ended by a STOP
+    uint32_t bytes = 0;        // Address and data bytes clocked
+    uint32_t nacks = 0;
+
+    void attach(uint8_t address, fake::I2cDevice* device) { devices[address & 0x7F] = device; }
+
+    void reset() {
+        for (auto& device : devices) {
+            device = nullptr;
+        }
+        transactions = 0;
+        bytes = 0;
+        nacks = 0;
+        txLength = 0;
+        rxLength = 0;
+        rxPosition = 0;
+    }
+
+    bool begin(int, int) { return true; }
+    size_t setBufferSize(size_t size) { return size; }
+
+    void beginTransmission(uint8_t address) {
+        txAddress = address;
+        txLength = 0;
+    }
+
+    size_t write(uint8_t value) { return write(&value, 1); }
+
+    size_t write(const uint8_t* data, size_t length) {
+        size_t count = std::min(length, BUFFER_SIZE - txLength);
+        memcpy(txBuffer + txLength, data, count);
+        txLength += count;
+        return count;
+    }
+
+    uint8_t endTransmission(bool stop = true) {
+        bytes += 1;
+        fake::I2cDevice* device = devices[txAddress & 0x7F];
+        if (device == nullptr || !device->write(txBuffer, txLength)) {
+            // The master sends a STOP after a NACK either way
+            transactions++;
+            nacks++;
+            return 2; // Address NACK
+        }
+        transactions += stop;
+        bytes += txLength;
+        return 0;
+    }
+
+    size_t requestFrom(uint8_t address, size_t length, bool stop = true) {
+        transactions += stop;
+        bytes += 1;
+        rxLength = 0;
+        rxPosition = 0;
+        fake::I2cDevice* device = devices[address & 0x7F];
+        length = std::min(length, BUFFER_SIZE);
+        if (device == nullptr || !device->read(rxBuffer, length)) {
+            nacks++;
+            return 0;
+        }
+        bytes += length;
+        rxLength = length;
+        return length;
+    }
+
+    int available() { return (int)(rxLength - rxPosition); }
+
+    int read() { return rxPosition < rxLength ? rxBuffer[rxPosition++] : -1; }
+
+    size_t readBytes(uint8_t* data, size_t length) {
+        size_t count = std::min(length, rxLength - rxPosition);
+        memcpy(data, rxBuffer + rxPosition, count);
+        rxPosition += count;
+        return count;
+    }
+
+private:
+    fake::I2cDevice* devices[128] = {};
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[BUFFER_SIZE];
+    size_t txLength = 0;
+    uint8_t rxBuffer[BUFFER_SIZE];
+    size_t rxLength = 0;
+    size_t rxPosition = 0;
+};
+
+inline TwoWire Wire;
+
+#endif // FAKE_WIRE_H
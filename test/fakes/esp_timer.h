@@ -0,0 +1,57 @@
+#ifndef FAKE_ESP_TIMER_H
+#define FAKE_ESP_TIMER_H
+
+#include "fake_platform.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef fake::Timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+inline int64_t esp_timer_get_time() { return fake::nowUs; }
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    for (fake::Timer& timer : fake::timers) {
+        if (!timer.created) {
+            timer = fake::Timer();
+            timer.callback = args->callback;
+            timer.arg = args->arg;
+            timer.created = true;
+            *handle = &timer;
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    timer->dueUs = fake::nowUs + timeoutUs;
+    timer->periodUs = 0;
+    timer->armed = true;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    timer->dueUs = fake::nowUs + periodUs;
+    timer->periodUs = periodUs;
+    timer->armed = true;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->armed = false;
+    return ESP_OK;
+}
+
+#endif // FAKE_ESP_TIMER_H
@@ -0,0 +1,81 @@
+#ifndef FAKE_24LC256_H
+#define FAKE_24LC256_H
+
+// 24LC256 model: 32 KB, two address bytes, 64-byte pages that wrap on a
+// page write, sequential reads that run on over the whole device, and no
+// ACK for 5 ms after a page write while the cell array is programmed.
+
+#include <Wire.h>
+
+namespace fake {
+
+class Eeprom24lc256 : public I2cDevice {
+public:
+    static const uint32_t SIZE = 32768;
+    static const uint16_t PAGE_SIZE = 64;
+    static const int64_t WRITE_CYCLE_US = 5000;
+    static const int64_t POLL_US = 25; // A NACKed address byte at 400 kHz
+
+    uint8_t memory[SIZE];
+    uint16_t pointer = 0;
+    int64_t busyUntilUs = 0;
+
+    uint32_t pageWrites = 0; // Write cycles started
+    uint32_t bytesProgrammed = 0;
+    uint32_t reads = 0;
+    uint32_t busyNacks = 0;
+    int32_t tearAfter = -1; // Bytes the next page write keeps before power fails
+
+    Eeprom24lc256() { erase(); }
+
+    void erase() { memset(memory, 0xFF, sizeof(memory)); }
+
+    bool busy() const { return nowUs < busyUntilUs; }
+
+    // The next page write only gets its first bytes into the array
+    void tearNextWrite(int32_t bytesKept) { tearAfter = bytesKept; }
+
+    bool write(const uint8_t* data, size_t length) override {
+        if (busy()) {
+            busyNacks++;
+            nowUs += POLL_US;
+            return false;
+        }
+        if (length >= 2) {
+            pointer = ((data[0] << 8) | data[1]) % SIZE;
+        }
+        if (length > 2) {
+            size_t count = length - 2;
+            if (tearAfter >= 0) {
+                count = std::min(count, (size_t)tearAfter);
+                tearAfter = -1;
+            }
+            uint16_t pageStart = pointer - pointer % PAGE_SIZE;
+            for (size_t i = 0; i < count; i++) {
+                memory[pageStart + (pointer - pageStart + i) % PAGE_SIZE] = data[2 + i];
+            }
+            pageWrites++;
+            bytesProgrammed += count;
+            busyUntilUs = nowUs + WRITE_CYCLE_US;
+        }
+        return true;
+    }
+
+    bool read(uint8_t* data, size_t length) override {
+        if (busy()) {
+            busyNacks++;
+            nowUs += POLL_US;
+            return false;
+        }
+        for (size_t i = 0; i < length; i++) {
+            data[i] = memory[pointer];
+            pointer = (pointer + 1) % SIZE;
+        }
+        reads++;
+        return true;
+    }
+};
+
+} // namespace fake
+
+#endif // FAKE_24LC256_H
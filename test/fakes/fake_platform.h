@@ -0,0 +1,132 @@
+#ifndef FAKE_PLATFORM_H
+#define FAKE_PLATFORM_H
+
+// Shared state behind the host fakes of the Arduino core, esp_timer and
+// FreeRTOS. Time only moves when a test moves it, so everything that
+// depends on timing runs the same way on every run.
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fake {
+
+inline int64_t nowUs = 0;
+
+// GPIO levels and the handlers passed to attachInterrupt()
+static const uint8_t PIN_COUNT = 64;
+inline int pinLevel[PIN_COUNT];
+inline void (*pinInterrupt[PIN_COUNT])() = {};
+
+// esp_timer: a fixed pool, fired by advance() in deadline order
+struct Timer {
+    void (*callback)(void*);
+    void* arg;
+    int64_t dueUs;
+    uint64_t periodUs; // 0 for one-shot timers
+    bool created;
+    bool armed;
+};
+static const uint8_t TIMER_COUNT = 8;
+inline Timer timers[TIMER_COUNT];
+
+// FreeRTOS tasks are never scheduled on their own. runTask() calls the task
+// function, and its xTaskNotifyWait() returns whatever was notified, or
+// unwinds back to runTask() once nothing is left.
+struct Task {
+    void (*function)(void*);
+    void* arg;
+    uint32_t notified;
+    bool created;
+};
+static const uint8_t TASK_COUNT = 4;
+inline Task tasks[TASK_COUNT + 1]; // Slot 0 is the task running the test
+inline Task* currentTask = &tasks[0];
+struct TaskBlocked {};
+
+inline void reset() {
+    nowUs = 0;
+    for (int& level : pinLevel) {
+        level = 1; // Inputs idle high on their pull-ups
+    }
+    for (auto& handler : pinInterrupt) {
+        handler = nullptr;
+    }
+    for (Timer& timer : timers) {
+        timer = Timer();
+    }
+    for (Task& task : tasks) {
+        task = Task();
+    }
+    tasks[0].created = true;
+    currentTask = &tasks[0];
+}
+
+// Move time forward to untilUs, firing every timer that falls due on the way
+inline void advanceTo(int64_t untilUs) {
+    for (;;) {
+        Timer* next = nullptr;
+        for (Timer& timer : timers) {
+            if (timer.armed && timer.dueUs <= untilUs && (next == nullptr || timer.dueUs < next->dueUs)) {
+                next = &timer;
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+        if (next->dueUs > nowUs) {
+            nowUs = next->dueUs;
+        }
+        if (next->periodUs > 0) {
+            next->dueUs += next->periodUs;
+        } else {
+            next->armed = false;
+        }
+        next->callback(next->arg);
+    }
+    if (untilUs > nowUs) {
+        nowUs = untilUs;
+    }
+}
+
+inline void advanceUs(int64_t us) {
+    advanceTo(nowUs + us);
+}
+
+inline void advanceMs(int64_t ms) {
+    advanceTo(nowUs + ms * 1000);
+}
+
+// Run a task created with xTaskCreatePinnedToCore() until it waits with
+// nothing left to handle
+inline void runTask(void* handle) {
+    Task* task = static_cast<Task*>(handle);
+    Task* previous = currentTask;
+    currentTask = task;
+    try {
+        task->function(task->arg);
+    } catch (const TaskBlocked&) {
+    }
+    currentTask = previous;
+}
+
+// Run every task with notifications pending
+inline void runTasks() {
+    for (int i = 1; i <= TASK_COUNT; i++) {
+        if (tasks[i].created && tasks[i].notified != 0) {
+            runTask(&tasks[i]);
+        }
+    }
+}
+
+// Drive an interrupt pin to level, calling its handler on a change
+inline void setPin(uint8_t pin, int level) {
+    bool changed = pinLevel[pin] != level;
+    pinLevel[pin] = level;
+    if (changed && pinInterrupt[pin] != nullptr) {
+        pinInterrupt[pin]();
+    }
+}
+
+} // namespace fake
+
+#endif // FAKE_PLATFORM_H
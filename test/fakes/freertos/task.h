@@ -0,0 +1,70 @@
+#ifndef FAKE_FREERTOS_TASK_H
+#define FAKE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+enum eNotifyAction { eNoAction, eSetBits, eIncrement };
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return fake::currentTask; }
+
+inline BaseType_t xTaskCreatePinnedToCore(void (*function)(void*), const char*, uint32_t, void* arg,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    for (int i = 1; i <= fake::TASK_COUNT; i++) {
+        fake::Task& task = fake::tasks[i];
+        if (!task.created) {
+            task = fake::Task();
+            task.function = function;
+            task.arg = arg;
+            task.created = true;
+            *handle = &task;
+            return pdPASS;
+        }
+    }
+    return pdFAIL;
+}
+
+inline BaseType_t xTaskNotify(TaskHandle_t handle, uint32_t bits, eNotifyAction) {
+    static_cast<fake::Task*>(handle)->notified |= bits;
+    return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyFromISR(TaskHandle_t handle, uint32_t bits, eNotifyAction action,
+                                     BaseType_t* higherPriorityTaskWoken) {
+    *higherPriorityTaskWoken = pdFALSE;
+    return xTaskNotify(handle, bits, action);
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+    static_cast<fake::Task*>(handle)->notified++;
+    return pdPASS;
+}
+
+// Returns straight away with whatever is pending; a task with nothing to do
+// hands control back to fake::runTask()
+inline BaseType_t xTaskNotifyWait(uint32_t, uint32_t clearOnExit, uint32_t* bits, TickType_t) {
+    fake::Task* task = fake::currentTask;
+    if (task->notified == 0 && task != &fake::tasks[0]) {
+        throw fake::TaskBlocked();
+    }
+    *bits = task->notified;
+    task->notified &= ~clearOnExit;
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t) {
+    fake::Task* task = fake::currentTask;
+    if (task->notified == 0 && task != &fake::tasks[0]) {
+        throw fake::TaskBlocked();
+    }
+    uint32_t count = task->notified;
+    task->notified = clearOnExit ? 0 : count - 1;
+    return count;
+}
+
+// Time only moves when a test moves it, so a delay moves it
+inline void vTaskDelay(TickType_t ticks) {
+    fake::advanceMs(ticks);
+}
+
+#endif // FAKE_FREERTOS_TASK_H
@@ -0,0 +1,208 @@
+#include <unity.h>
+#include <Wire.h>
+#include "clock.h"
+
+// DS3231 register file: a write sets the register pointer and stores any
+// bytes after it, reads carry on from the pointer
+class FakeDs3231 : public fake::I2cDevice {
+public:
+    uint8_t registers[0x13] = {};
+    uint8_t pointer = 0;
+
+    bool write(const uint8_t* data, size_t length) override {
+        if (length > 0) {
+            pointer = data[0];
+            for (size_t i = 1; i < length; i++) {
+                registers[pointer++ % sizeof(registers)] = data[i];
+            }
+        }
+        return true;
+    }
+
+    bool read(uint8_t* data, size_t length) override {
+        for (size_t i = 0; i < length; i++) {
+            data[i] = registers[pointer++ % sizeof(registers)];
+        }
+        return true;
+    }
+
+    void setTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t day, uint8_t date,
+                 uint8_t month, uint8_t year) {
+        const uint8_t values[] = {seconds, minutes, hours, day, date, month, year};
+        for (uint8_t i = 0; i < sizeof(values); i++) {
+            registers[i] = ((values[i] / 10) << 4) | (values[i] % 10);
+        }
+    }
+};
+
+static const uint8_t RTC_ADDRESS = 0x68;
+static const int SQW_PIN = 1;
+
+static FakeDs3231 rtc;
+
+// One SQW falling edge, then the loop's Clock::update()
+static void tick(uint32_t count = 1) {
+    for (uint32_t i = 0; i < count; i++) {
+        fake::pinInterrupt[SQW_PIN]();
+        Clock::update();
+    }
+}
+
+static void start(uint32_t resyncSeconds) {
+    Clock::init(SQW_PIN);
+    Clock::enableSQWInterrupt();
+    Clock::setResyncInterval(resyncSeconds);
+    Wire.transactions = 0;
+}
+
+void setUp() {
+    fake::reset();
+    Wire.reset();
+    Wire.attach(RTC_ADDRESS, &rtc);
+    rtc = FakeDs3231();
+    rtc.setTime(12, 0, 0, 3, 15, 6, 25);
+}
+
+void tearDown() {}
+
+void test_init_reads_all_time_registers_in_one_transaction() {
+    rtc.setTime(23, 59, 58, 6, 28, 2, 24);
+    Clock::init(SQW_PIN);
+
+    // Square wave setup, then a single burst read
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.transactions);
+    const Clock::Snapshot& now = Clock::getSnapshot();
+    TEST_ASSERT_EQUAL_UINT8(58, now.seconds);
+    TEST_ASSERT_EQUAL_UINT8(59, now.minutes);
+    TEST_ASSERT_EQUAL_UINT8(23, now.hours);
+    TEST_ASSERT_EQUAL_UINT8(6, now.dayOfWeek);
+    TEST_ASSERT_EQUAL_UINT8(28, now.date);
+    TEST_ASSERT_EQUAL_UINT8(2, now.month);
+    TEST_ASSERT_EQUAL_UINT16(2024, now.year);
+}
+
+void test_accessors_are_served_from_the_snapshot() {
+    rtc.setTime(7, 45, 10, 2, 3, 11, 25);
+    start(3600);
+
+    TEST_ASSERT_EQUAL_UINT8(7, Clock::getCurrentHours());
+    TEST_ASSERT_EQUAL_UINT8(45, Clock::getCurrentMinutes());
+    TEST_ASSERT_EQUAL_UINT16(7 * 60 + 45, Clock::getMinutesSinceMidnight());
+    TEST_ASSERT_EQUAL_UINT8(2, Clock::getCurrentDayOfWeek());
+    TEST_ASSERT_EQUAL_UINT8(3, Clock::getCurrentDate());
+    TEST_ASSERT_EQUAL_UINT8(11, Clock::getCurrentMonth());
+    TEST_ASSERT_EQUAL_UINT16(2025, Clock::getCurrentYear());
+    TEST_ASSERT_EQUAL_STRING(" 745", Clock::getTimeString().c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.transactions);
+}
+
+void test_one_transaction_per_tick_when_resyncing_every_second() {
+    start(1);
+    for (int i = 0; i < 120; i++) {
+        uint32_t before = Wire.transactions;
+        tick();
+        TEST_ASSERT_EQUAL_UINT32(1, Wire.transactions - before);
+    }
+}
+
+void test_ticks_between_resyncs_do_not_touch_the_bus() {
+    start(60);
+    tick(59);
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.transactions);
+    TEST_ASSERT_EQUAL_UINT8(59, Clock::getSnapshot().seconds);
+
+    tick();
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.transactions);
+}
+
+void test_stalled_loop_applies_every_missed_tick() {
+    start(3600);
+    for (int i = 0; i < 90; i++) {
+        fake::pinInterrupt[SQW_PIN]();
+    }
+    Clock::update();
+
+    TEST_ASSERT_EQUAL_UINT8(1, Clock::getCurrentMinutes());
+    TEST_ASSERT_EQUAL_UINT8(30, Clock::getSnapshot().seconds);
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.transactions);
+}
+
+void test_ticks_carry_through_the_calendar() {
+    // Saturday 31 December 2025, 23:59:59 (the RTC counts days 1-7)
+    rtc.setTime(23, 59, 59, 7, 31, 12, 25);
+    start(3600);
+    tick();
+
+    const Clock::Snapshot& now = Clock::getSnapshot();
+    TEST_ASSERT_EQUAL_UINT8(0, now.hours);
+    TEST_ASSERT_EQUAL_UINT8(0, now.minutes);
+    TEST_ASSERT_EQUAL_UINT8(0, now.seconds);
+    TEST_ASSERT_EQUAL_UINT8(1, now.dayOfWeek);
+    TEST_ASSERT_EQUAL_UINT8(1, now.date);
+    TEST_ASSERT_EQUAL_UINT8(1, now.month);
+    TEST_ASSERT_EQUAL_UINT16(2026, now.year);
+}
+
+void test_ticks_respect_leap_years() {
+    rtc.setTime(23, 59, 59, 4, 28, 2, 24);
+    start(3600);
+    tick();
+    TEST_ASSERT_EQUAL_UINT8(29, Clock::getCurrentDate());
+    TEST_ASSERT_EQUAL_UINT8(2, Clock::getCurrentMonth());
+
+    rtc.setTime(23, 59, 59, 6, 28, 2, 25);
+    start(3600);
+    tick();
+    TEST_ASSERT_EQUAL_UINT8(1, Clock::getCurrentDate());
+    TEST_ASSERT_EQUAL_UINT8(3, Clock::getCurrentMonth());
+}
+
+void test_resync_replaces_the_software_clock() {
+    rtc.setTime(8, 0, 0, 1, 5, 1, 26);
+    start(10);
+    rtc.setTime(8, 0, 30, 1, 5, 1, 26); // The RTC has moved on without us
+
+    tick(9);
+    TEST_ASSERT_EQUAL_UINT8(9, Clock::getSnapshot().seconds);
+    tick();
+    TEST_ASSERT_EQUAL_UINT8(30, Clock::getSnapshot().seconds);
+}
+
+void test_failed_resync_keeps_counting_and_retries() {
+    start(5);
+    Wire.attach(RTC_ADDRESS, nullptr);
+
+    tick(5);
+    TEST_ASSERT_EQUAL_UINT8(5, Clock::getSnapshot().seconds);
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.transactions);
+
+    tick();
+    TEST_ASSERT_EQUAL_UINT8(6, Clock::getSnapshot().seconds);
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.transactions);
+}
+
+void test_set_time_writes_and_reads_back_once() {
+    start(3600);
+    Clock::setTime(6, 30, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.transactions);
+    TEST_ASSERT_EQUAL_HEX8(0x30, rtc.registers[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, rtc.registers[2]);
+    TEST_ASSERT_EQUAL_UINT8(6, Clock::getCurrentHours());
+    TEST_ASSERT_EQUAL_UINT8(30, Clock::getCurrentMinutes());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_init_reads_all_time_registers_in_one_transaction);
+    RUN_TEST(test_accessors_are_served_from_the_snapshot);
+    RUN_TEST(test_one_transaction_per_tick_when_resyncing_every_second);
+    RUN_TEST(test_ticks_between_resyncs_do_not_touch_the_bus);
+    RUN_TEST(test_stalled_loop_applies_every_missed_tick);
+    RUN_TEST(test_ticks_carry_through_the_calendar);
+    RUN_TEST(test_ticks_respect_leap_years);
+    RUN_TEST(test_resync_replaces_the_software_clock);
+    RUN_TEST(test_failed_resync_keeps_counting_and_retries);
+    RUN_TEST(test_set_time_writes_and_reads_back_once);
+    return UNITY_END();
+}
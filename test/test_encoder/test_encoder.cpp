@@ -0,0 +1,170 @@
+#include <unity.h>
+#include <vector>
+#include "encoder.h"
+#include "events.h"
+
+static const uint8_t SW_PIN = 4;
+static const uint32_t SAMPLE_US = 5000;
+
+// Toggle the switch edges times, spacingUs apart, ending at level. An odd
+// count of edges from the other level lands on level, like a real contact.
+static void bounce(int level, int edges, int64_t spacingUs) {
+    for (int i = edges - 1; i >= 0; i--) {
+        fake::setPin(SW_PIN, (i % 2 == 0) ? level : !level);
+        fake::advanceUs(spacingUs);
+    }
+}
+
+static void press() { fake::setPin(SW_PIN, LOW); }
+static void release() { fake::setPin(SW_PIN, HIGH); }
+
+// Every action the loop would see right now
+static std::vector<Action> actions() {
+    std::vector<Action> seen;
+    for (ActionEvent event = Encoder::getAction(); event.action != NONE; event = Encoder::getAction()) {
+        seen.push_back(event.action);
+    }
+    return seen;
+}
+
+static bool samplerRunning() {
+    for (const fake::Timer& timer : fake::timers) {
+        if (timer.armed && timer.periodUs == SAMPLE_US) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void setUp() {
+    fake::reset();
+    Encoder::init();
+    Events::init();
+}
+
+// Leave the recognizer settled and idle for the next test
+void tearDown() {
+    release();
+    fake::advanceMs(1000);
+    actions();
+}
+
+void test_clean_press_selects_once_after_the_debounce() {
+    press();
+    fake::advanceMs(45);
+    TEST_ASSERT_EQUAL(0, actions().size());
+
+    fake::advanceMs(10);
+    std::vector<Action> seen = actions();
+    TEST_ASSERT_EQUAL(1, seen.size());
+    TEST_ASSERT_EQUAL(SELECT, seen[0]);
+    TEST_ASSERT_TRUE(fake::tasks[0].notified & EVENT_BUTTON);
+
+    fake::advanceMs(500);
+    release();
+    fake::advanceMs(100);
+    TEST_ASSERT_EQUAL(0, actions().size());
+}
+
+void test_contact_bounce_gives_one_press_and_no_release_press() {
+    bounce(LOW, 9, 700); // 6 ms of chatter closing
+    fake::advanceMs(100);
+    bounce(HIGH, 11, 400); // 4 ms of chatter opening
+    fake::advanceMs(500);
+
+    std::vector<Action> seen = actions();
+    TEST_ASSERT_EQUAL(1, seen.size());
+    TEST_ASSERT_EQUAL(SELECT, seen[0]);
+    TEST_ASSERT_FALSE(samplerRunning());
+}
+
+void test_short_glitches_never_register() {
+    // 20 ms low, 30 ms high: the integrator never reaches the threshold
+    for (int i = 0; i < 40; i++) {
+        press();
+        fake::advanceMs(20);
+        release();
+        fake::advanceMs(30);
+    }
+    TEST_ASSERT_EQUAL(0, actions().size());
+}
+
+void test_hold_fires_while_the_button_is_still_down() {
+    press();
+    fake::advanceMs(100);
+    TEST_ASSERT_EQUAL(SELECT, actions().at(0));
+
+    // Counted from the debounced press, 50 ms after the edge
+    fake::advanceMs(2900);
+    TEST_ASSERT_EQUAL(0, actions().size());
+    fake::advanceMs(100);
+    std::vector<Action> seen = actions();
+    TEST_ASSERT_EQUAL(1, seen.size());
+    TEST_ASSERT_EQUAL(SELECT_HOLD, seen[0]);
+
+    // Only once, and letting go afterwards adds nothing
+    fake::advanceMs(5000);
+    release();
+    fake::advanceMs(500);
+    TEST_ASSERT_EQUAL(0, actions().size());
+    TEST_ASSERT_FALSE(samplerRunning());
+}
+
+void test_sampler_stops_once_the_release_settles() {
+    press();
+    fake::advanceMs(100);
+    release();
+    fake::advanceMs(30);
+    TEST_ASSERT_TRUE(samplerRunning()); // Still debouncing the release
+
+    fake::advanceMs(30);
+    TEST_ASSERT_FALSE(samplerRunning());
+    TEST_ASSERT_EQUAL(1, actions().size());
+}
+
+// Nothing waits to see whether a second click follows
+void test_quick_second_press_is_a_second_select() {
+    bounce(LOW, 5, 500);
+    fake::advanceMs(100);
+    bounce(HIGH, 5, 500);
+    fake::advanceMs(150);
+    bounce(LOW, 5, 500);
+    fake::advanceMs(100);
+    bounce(HIGH, 5, 500);
+    fake::advanceMs(60);
+
+    TEST_ASSERT_FALSE(samplerRunning());
+    std::vector<Action> seen = actions();
+    TEST_ASSERT_EQUAL(2, seen.size());
+    TEST_ASSERT_EQUAL(SELECT, seen[0]);
+    TEST_ASSERT_EQUAL(SELECT, seen[1]);
+}
+
+void test_button_held_through_boot_is_not_a_press() {
+    tearDown();
+    fake::reset();
+    press();
+    Encoder::init();
+    Events::init();
+
+    fake::advanceMs(4000);
+    TEST_ASSERT_EQUAL(0, actions().size());
+
+    release();
+    fake::advanceMs(500);
+    press();
+    fake::advanceMs(100);
+    TEST_ASSERT_EQUAL(SELECT, actions().at(0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_press_selects_once_after_the_debounce);
+    RUN_TEST(test_contact_bounce_gives_one_press_and_no_release_press);
+    RUN_TEST(test_short_glitches_never_register);
+    RUN_TEST(test_hold_fires_while_the_button_is_still_down);
+    RUN_TEST(test_sampler_stops_once_the_release_settles);
+    RUN_TEST(test_quick_second_press_is_a_second_select);
+    RUN_TEST(test_button_held_through_boot_is_not_a_press);
+    return UNITY_END();
+}
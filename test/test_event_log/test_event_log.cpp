@@ -0,0 +1,182 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include <fake_24lc256.h>
+#include "event_log.h"
+
+static const uint8_t EEPROM_ADDRESS = 0x57;
+static const uint16_t SLOT_COUNT = 2048;
+
+static fake::Eeprom24lc256 device;
+
+class StringPrint : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+};
+
+struct Dump {
+    std::vector<uint32_t> sequences; // Oldest first
+    std::string summary;             // The closing line
+};
+
+static Dump dump() {
+    StringPrint out;
+    EventLog::dump(out);
+    Dump result;
+    size_t start = 0;
+    while (start < out.text.size()) {
+        size_t end = out.text.find('\n', start);
+        std::string line = out.text.substr(start, end - start);
+        if (line[0] == '#') {
+            result.sequences.push_back(strtoul(line.c_str() + 1, nullptr, 10));
+        } else {
+            result.summary = line;
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+// Give the log enough loop passes, each after a write cycle, to empty its queue
+static void settle() {
+    for (int i = 0; i < 8; i++) {
+        fake::advanceMs(6);
+        EventLog::update();
+    }
+}
+
+static void append(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        EventLog::record(EventLog::STATE_CHANGE, 1, 2, i);
+        if (i % 4 == 3) {
+            settle();
+        }
+    }
+    settle();
+}
+
+static void reboot() {
+    fake::advanceMs(10);
+    TEST_ASSERT_TRUE(EventLog::init());
+}
+
+static void assertRun(const std::vector<uint32_t>& sequences, uint32_t first, uint32_t count) {
+    TEST_ASSERT_EQUAL_UINT32(count, sequences.size());
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(first + i, sequences[i]);
+    }
+}
+
+void setUp() {
+    fake::reset();
+    Wire.reset();
+    device = fake::Eeprom24lc256();
+    Wire.attach(EEPROM_ADDRESS, &device);
+}
+
+void tearDown() {}
+
+void test_fresh_device_starts_empty() {
+    reboot();
+    Dump result = dump();
+    TEST_ASSERT_EQUAL(0, result.sequences.size());
+    TEST_ASSERT_EQUAL_STRING("0 records stored, 0 queued", result.summary.c_str());
+}
+
+void test_missing_device_leaves_the_log_unavailable() {
+    Wire.attach(EEPROM_ADDRESS, nullptr);
+    TEST_ASSERT_FALSE(EventLog::init());
+    EventLog::record(EventLog::BOOT);
+    EventLog::update();
+    TEST_ASSERT_EQUAL_STRING("Event log unavailable", dump().summary.c_str());
+}
+
+void test_records_survive_a_reboot_and_numbering_carries_on() {
+    reboot();
+    append(10);
+    reboot();
+    assertRun(dump().sequences, 0, 10);
+
+    append(3);
+    reboot();
+    assertRun(dump().sequences, 0, 13);
+}
+
+void test_records_queue_until_update() {
+    reboot();
+    for (int i = 0; i < 10; i++) {
+        EventLog::record(EventLog::BOOT);
+    }
+    TEST_ASSERT_EQUAL_STRING("0 records stored, 8 queued", dump().summary.c_str());
+    settle();
+    TEST_ASSERT_EQUAL_STRING("8 records stored, 0 queued", dump().summary.c_str());
+}
+
+// A lap and a bit: the oldest records are overwritten and the head is
+// still found after a reboot
+void test_wrap_around_keeps_the_newest_lap() {
+    reboot();
+    append(SLOT_COUNT + 100);
+    reboot();
+    assertRun(dump().sequences, 100, SLOT_COUNT);
+
+    append(1);
+    assertRun(dump().sequences, 101, SLOT_COUNT);
+}
+
+void test_recovery_reads_only_a_few_slots() {
+    reboot();
+    append(1500);
+    uint32_t before = device.reads;
+    reboot();
+    // Slot 0 and a binary search over 2047 slots
+    TEST_ASSERT_LESS_OR_EQUAL(13, device.reads - before);
+    assertRun(dump().sequences, 0, 1500);
+}
+
+void test_torn_write_is_dropped_and_its_slot_reused() {
+    reboot();
+    append(10);
+    device.tearNextWrite(5);
+    EventLog::record(EventLog::BOOT);
+    settle();
+    reboot();
+    assertRun(dump().sequences, 0, 10);
+
+    append(2);
+    reboot();
+    assertRun(dump().sequences, 0, 12);
+}
+
+// The tear lands on slot 0 at the start of a new lap, so the head is
+// recovered from the end of the previous one
+void test_torn_first_write_of_a_lap_falls_back_to_the_previous_lap() {
+    reboot();
+    append(SLOT_COUNT);
+    device.tearNextWrite(3);
+    EventLog::record(EventLog::BOOT);
+    settle();
+    reboot();
+    assertRun(dump().sequences, 1, SLOT_COUNT - 1);
+
+    append(1);
+    reboot();
+    assertRun(dump().sequences, 1, SLOT_COUNT);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fresh_device_starts_empty);
+    RUN_TEST(test_missing_device_leaves_the_log_unavailable);
+    RUN_TEST(test_records_survive_a_reboot_and_numbering_carries_on);
+    RUN_TEST(test_records_queue_until_update);
+    RUN_TEST(test_wrap_around_keeps_the_newest_lap);
+    RUN_TEST(test_recovery_reads_only_a_few_slots);
+    RUN_TEST(test_torn_write_is_dropped_and_its_slot_reused);
+    RUN_TEST(test_torn_first_write_of_a_lap_falls_back_to_the_previous_lap);
+    return UNITY_END();
+}
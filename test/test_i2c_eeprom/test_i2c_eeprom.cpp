@@ -0,0 +1,206 @@
+#include <unity.h>
+#include <fake_24lc256.h>
+#include "i2c_eeprom.h"
+
+static const uint8_t EEPROM_ADDRESS = 0x57;
+
+static fake::Eeprom24lc256 device;
+
+static I2cEeprom makeEeprom() {
+    return I2cEeprom(EEPROM_ADDRESS, fake::Eeprom24lc256::SIZE, fake::Eeprom24lc256::PAGE_SIZE);
+}
+
+static void pattern(uint8_t* data, size_t length, uint8_t seed) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+void setUp() {
+    fake::reset();
+    Wire.reset();
+    device = fake::Eeprom24lc256();
+    Wire.attach(EEPROM_ADDRESS, &device);
+}
+
+void tearDown() {}
+
+void test_begin_probes_for_the_device() {
+    I2cEeprom eeprom = makeEeprom();
+    TEST_ASSERT_TRUE(eeprom.begin());
+    Wire.attach(EEPROM_ADDRESS, nullptr);
+    TEST_ASSERT_FALSE(eeprom.begin());
+}
+
+void test_small_writes_to_one_page_go_out_as_one_page_write() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t data[64];
+    pattern(data, sizeof(data), 1);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_TRUE(eeprom.write(128 + i * 8, data + i * 8, 8));
+    }
+    TEST_ASSERT_TRUE(eeprom.isDirty());
+    TEST_ASSERT_EQUAL_UINT32(0, device.pageWrites);
+
+    TEST_ASSERT_TRUE(eeprom.flush());
+    TEST_ASSERT_FALSE(eeprom.isDirty());
+    TEST_ASSERT_EQUAL_UINT32(1, device.pageWrites);
+    TEST_ASSERT_EQUAL_UINT32(64, device.bytesProgrammed);
+    TEST_ASSERT_EQUAL_MEMORY(data, device.memory + 128, 64);
+    TEST_ASSERT_EQUAL_UINT32(8, eeprom.getStats().logicalWrites);
+    TEST_ASSERT_EQUAL_UINT32(1, eeprom.getStats().writeCycles);
+}
+
+void test_write_across_pages_is_split_at_page_boundaries() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t data[100];
+    pattern(data, sizeof(data), 3);
+    TEST_ASSERT_TRUE(eeprom.write(40, data, sizeof(data)));
+    TEST_ASSERT_TRUE(eeprom.flush());
+
+    // 24 + 64 + 12 bytes, none of them wrapped back to a page start
+    TEST_ASSERT_EQUAL_UINT32(3, device.pageWrites);
+    TEST_ASSERT_EQUAL_MEMORY(data, device.memory + 40, sizeof(data));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, device.memory[39]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, device.memory[140]);
+}
+
+void test_gap_in_a_page_forces_a_separate_write() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t data[4] = {1, 2, 3, 4};
+    eeprom.write(0, data, 4);
+    eeprom.write(32, data, 4); // Would rewrite 4-31 with stale bytes if combined
+    eeprom.flush();
+    TEST_ASSERT_EQUAL_UINT32(2, device.pageWrites);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, device.memory[4]);
+    TEST_ASSERT_EQUAL_HEX8(4, device.memory[35]);
+}
+
+void test_reads_see_writes_not_yet_flushed() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t before[48];
+    TEST_ASSERT_TRUE(eeprom.read(0, before, 16));  // Through the cache
+    TEST_ASSERT_TRUE(eeprom.read(0, before, 48));  // Burst, past the cache
+
+    uint8_t data[8] = {9, 8, 7, 6, 5, 4, 3, 2};
+    eeprom.write(20, data, sizeof(data));
+    uint8_t small[8];
+    uint8_t large[48];
+    TEST_ASSERT_TRUE(eeprom.read(20, small, sizeof(small)));
+    TEST_ASSERT_TRUE(eeprom.read(0, large, sizeof(large)));
+    TEST_ASSERT_EQUAL_MEMORY(data, small, sizeof(data));
+    TEST_ASSERT_EQUAL_MEMORY(data, large + 20, sizeof(data));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, device.memory[20]);
+}
+
+void test_short_reads_hit_the_cache() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t data[16];
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(eeprom.read(64 + (i % 2) * 16, data, sizeof(data)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, device.reads);
+    TEST_ASSERT_EQUAL_UINT32(1, eeprom.getStats().cacheMisses);
+    TEST_ASSERT_EQUAL_UINT32(9, eeprom.getStats().cacheHits);
+}
+
+void test_long_reads_are_bursts_of_the_bus_buffer() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    pattern(device.memory + 1000, 2000, 5);
+    uint8_t data[2000];
+    TEST_ASSERT_TRUE(eeprom.read(1000, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_MEMORY(device.memory + 1000, data, sizeof(data));
+    TEST_ASSERT_EQUAL_UINT32(4, device.reads); // 512-byte bursts
+    TEST_ASSERT_EQUAL_UINT32(4, eeprom.getStats().burstReads);
+}
+
+void test_write_cycle_is_waited_out_by_ack_polling() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t data[4] = {1, 2, 3, 4};
+    eeprom.write(0, data, 4);
+    eeprom.flush();
+    TEST_ASSERT_TRUE(eeprom.isBusy());
+
+    int64_t start = fake::nowUs;
+    eeprom.write(64, data, 4);
+    TEST_ASSERT_TRUE(eeprom.flush());
+    int64_t waited = fake::nowUs - start;
+
+    // Done as soon as the device answers, not after a fixed worst case
+    TEST_ASSERT_GREATER_OR_EQUAL(4900, waited);
+    TEST_ASSERT_LESS_OR_EQUAL(5100, waited);
+    TEST_ASSERT_GREATER_THAN(0, eeprom.getStats().ackPolls);
+    TEST_ASSERT_EQUAL_UINT32(2, device.pageWrites);
+    TEST_ASSERT_EQUAL_MEMORY(data, device.memory + 64, 4);
+}
+
+void test_stats_account_for_every_byte_on_the_bus() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    uint8_t data[200];
+    pattern(data, sizeof(data), 11);
+    for (int i = 0; i < 20; i++) {
+        eeprom.write(i * 37, data + i * 5, 10);
+        eeprom.read(i * 53, data, 12);
+    }
+    eeprom.read(0, data, sizeof(data));
+    eeprom.flush();
+    eeprom.read(0, data, sizeof(data));
+    TEST_ASSERT_EQUAL_UINT32(Wire.bytes, eeprom.getStats().busBytes);
+}
+
+// Benchmark: 16-byte log records appended back to back, the event log's
+// pattern, against one page write per record. A flush that has to wait
+// polls for the whole write cycle, so polls are counted apart.
+void test_benchmark_bus_bytes_and_write_cycles_per_record() {
+    I2cEeprom eeprom = makeEeprom();
+    eeprom.begin();
+    const uint32_t RECORDS = 2048;
+    uint8_t record[16];
+    for (uint32_t i = 0; i < RECORDS; i++) {
+        pattern(record, sizeof(record), (uint8_t)i);
+        TEST_ASSERT_TRUE(eeprom.write(i * sizeof(record), record, sizeof(record)));
+    }
+    eeprom.flush();
+    const I2cEeprom::Stats& stats = eeprom.getStats();
+
+    uint32_t transferBytes = stats.busBytes - stats.ackPolls - 1; // Less the probe in begin()
+    uint32_t unbufferedBytes = RECORDS * (3 + sizeof(record));
+    char message[200];
+    snprintf(message, sizeof(message),
+             "%lu records: %lu write cycles (%.2f per write), %.2f transfer bytes per write "
+             "(unbuffered %u), %.0f ACK polls per write cycle",
+             (unsigned long)RECORDS, (unsigned long)stats.writeCycles,
+             (double)stats.writeCycles / stats.logicalWrites,
+             (double)transferBytes / stats.logicalWrites, (unsigned)(3 + sizeof(record)),
+             (double)stats.ackPolls / stats.writeCycles);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT32(RECORDS / 4, stats.writeCycles);
+    TEST_ASSERT_LESS_THAN(unbufferedBytes, transferBytes);
+    uint32_t pollsPerCycle = fake::Eeprom24lc256::WRITE_CYCLE_US / fake::Eeprom24lc256::POLL_US + 1;
+    TEST_ASSERT_LESS_OR_EQUAL(stats.writeCycles * pollsPerCycle, stats.ackPolls);
+    TEST_ASSERT_EQUAL_MEMORY(record, device.memory + (RECORDS - 1) * sizeof(record), sizeof(record));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_probes_for_the_device);
+    RUN_TEST(test_small_writes_to_one_page_go_out_as_one_page_write);
+    RUN_TEST(test_write_across_pages_is_split_at_page_boundaries);
+    RUN_TEST(test_gap_in_a_page_forces_a_separate_write);
+    RUN_TEST(test_reads_see_writes_not_yet_flushed);
+    RUN_TEST(test_short_reads_hit_the_cache);
+    RUN_TEST(test_long_reads_are_bursts_of_the_bus_buffer);
+    RUN_TEST(test_write_cycle_is_waited_out_by_ack_polling);
+    RUN_TEST(test_stats_account_for_every_byte_on_the_bus);
+    RUN_TEST(test_benchmark_bus_bytes_and_write_cycles_per_record);
+    return UNITY_END();
+}
@@ -0,0 +1,66 @@
+#include <unity.h>
+#include <string>
+
+// The native build compiles log calls out of the firmware. This suite puts
+// them back for its own call sites, which go through the same Log class.
+#undef LOG_COMPILE_LEVEL
+#include "logging.h"
+
+#define LOG_MODULE LOG_CLOCK
+
+static const uint32_t MINUTE_MS = 60000;
+
+// Stand-ins for the per-minute lines in clock.cpp, one call site each
+static void timeUpdated(uint32_t minute) {
+    LOG_INFO("Time updated: %02d:%02d:%02d %s (String: %s)", (int)(minute / 60 % 12), (int)(minute % 60), 0,
+             "AM", "...");
+}
+
+static void rtcError(uint32_t minute) {
+    LOG_ERROR("Error reading from RTC, retrying next tick (%lu)", (unsigned long)minute);
+}
+
+static uint32_t linesContaining(const char* text) {
+    uint32_t count = 0;
+    for (size_t at = Serial.output.find(text); at != std::string::npos; at = Serial.output.find(text, at + 1)) {
+        count++;
+    }
+    return count;
+}
+
+void setUp() {
+    fake::reset();
+    Serial.output.clear();
+    Serial.recording = true;
+}
+
+void tearDown() {
+    Serial.recording = false;
+}
+
+// The default limit lets a once-a-minute INFO site through 3 times an hour,
+// plus the summary of what it held back
+void test_once_a_minute_site_is_held_to_a_few_lines_an_hour() {
+    for (uint32_t minute = 0; minute < 3 * 60; minute++) {
+        timeUpdated(minute);
+        fake::advanceMs(MINUTE_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(9, linesContaining("[INFO] Time updated"));
+    TEST_ASSERT_EQUAL_UINT32(2, linesContaining("Suppressed 57 messages like \"Time updated"));
+}
+
+void test_errors_are_never_rate_limited() {
+    for (uint32_t minute = 0; minute < 120; minute++) {
+        rtcError(minute);
+        fake::advanceMs(MINUTE_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(120, linesContaining("[ERROR] Error reading from RTC"));
+    TEST_ASSERT_EQUAL_UINT32(0, linesContaining("Suppressed"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_once_a_minute_site_is_held_to_a_few_lines_an_hour);
+    RUN_TEST(test_errors_are_never_rate_limited);
+    return UNITY_END();
+}
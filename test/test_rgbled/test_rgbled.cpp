@@ -0,0 +1,269 @@
+#include <unity.h>
+#include <Adafruit_NeoPixel.h>
+#include <chrono>
+#include "rgbled.h"
+#include "settings.h"
+
+extern Adafruit_NeoPixel pixels;
+
+static const uint16_t PIXEL_COUNT = 16;
+
+static uint8_t red(uint32_t color) { return color >> 16 & 0xFF; }
+static uint8_t green(uint32_t color) { return color >> 8 & 0xFF; }
+static uint8_t blue(uint32_t color) { return color & 0xFF; }
+
+static double elapsedNs(std::chrono::steady_clock::time_point start, uint32_t count) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+// Period of the running fade timer, 0 when no fade is running
+static uint32_t frameIntervalUs() {
+    for (const fake::Timer& timer : fake::timers) {
+        if (timer.armed && timer.periodUs > 0) {
+            return (uint32_t)timer.periodUs;
+        }
+    }
+    return 0;
+}
+
+// Let the frame timer and the LED task run for ms, returning the frames shown
+static uint32_t play(uint32_t ms) {
+    uint32_t before = pixels.showCount;
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed++) {
+        fake::advanceMs(1);
+        fake::runTasks();
+    }
+    return pixels.showCount - before;
+}
+
+void setUp() {
+    fake::reset();
+    pixels.showCostUs = 0;
+    TEST_ASSERT_TRUE(Settings::init());
+    RgbLed::setBrightness(255);
+    RgbLed::init();
+    RgbLed::turnOff();
+    fake::advanceMs(5000); // Let anything left from the last test play out
+    fake::runTasks();
+    pixels.showCount = 0;
+}
+
+void tearDown() {}
+
+void test_frames_go_out_from_the_led_task() {
+    RgbLed::indicateStatus(SLEEP);
+    TEST_ASSERT_EQUAL_UINT32(0, pixels.showCount);
+
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(1, pixels.showCount);
+    for (uint16_t i = 0; i < PIXEL_COUNT; i++) {
+        TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(255, 0, 0), pixels.shownColor[i]);
+    }
+}
+
+void test_unchanged_frames_are_skipped() {
+    // Timeline asks once a minute whether the block changed or not
+    for (int minute = 0; minute < 60; minute++) {
+        RgbLed::indicateStatus(QUIET);
+        fake::runTasks();
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, pixels.showCount);
+
+    RgbLed::turnOff();
+    RgbLed::turnOff();
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(2, pixels.showCount);
+    TEST_ASSERT_EQUAL_HEX32(0, pixels.shownColor[0]);
+}
+
+void test_frames_posted_while_the_task_is_busy_collapse_to_the_latest() {
+    RgbLed::indicateStatus(WIND_DOWN);
+    RgbLed::indicateStatus(WAKE);
+    RgbLed::indicateStatus(QUIET);
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(1, pixels.showCount);
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(255, 255, 0), pixels.shownColor[0]);
+}
+
+void test_brightness_change_redraws_the_same_colour() {
+    RgbLed::indicateStatus(QUIET);
+    fake::runTasks();
+    RgbLed::setBrightness(127);
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(2, pixels.showCount);
+    TEST_ASSERT_EQUAL_UINT8(127, red(pixels.shownColor[0]));
+    TEST_ASSERT_EQUAL_UINT8(127, green(pixels.shownColor[0]));
+    TEST_ASSERT_EQUAL_UINT8(0, blue(pixels.shownColor[0]));
+
+    RgbLed::setBrightness(127);
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(2, pixels.showCount);
+}
+
+// Benchmark: host cost of a requested frame, shown or skipped, including
+// the hand-off to the LED task
+void test_benchmark_frame_cost() {
+    const uint32_t FRAMES = 200000;
+    const ScheduleBlock blocks[] = {SLEEP, QUIET};
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        RgbLed::indicateStatus(blocks[i % 2]);
+        fake::runTasks();
+    }
+    double shownNs = elapsedNs(start, FRAMES);
+    TEST_ASSERT_EQUAL_UINT32(FRAMES, pixels.showCount);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        RgbLed::indicateStatus(QUIET);
+        fake::runTasks();
+    }
+    double skippedNs = elapsedNs(start, FRAMES);
+    TEST_ASSERT_EQUAL_UINT32(FRAMES, pixels.showCount);
+
+    char message[120];
+    snprintf(message, sizeof(message), "%lu frames: %.0f ns per shown frame, %.0f ns per skipped frame",
+             (unsigned long)FRAMES, shownNs, skippedNs);
+    TEST_MESSAGE(message);
+}
+
+void test_sleep_crossfade_steps_on_the_frame_timer() {
+    RgbLed::indicateStatus(WIND_DOWN);
+    fake::runTasks();
+    RgbLed::indicateStatus(SLEEP);
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(20000, frameIntervalUs());
+
+    uint32_t frames = 0;
+    uint8_t lastRed = 0;
+    uint8_t lastBlue = 255;
+    uint8_t halfwayRed = 0;
+    for (uint32_t ms = 0; ms < 2100; ms += 20) {
+        frames += play(20);
+        uint32_t color = pixels.shownColor[0];
+        TEST_ASSERT_GREATER_OR_EQUAL(lastRed, red(color));
+        TEST_ASSERT_LESS_OR_EQUAL(lastBlue, blue(color));
+        lastRed = red(color);
+        lastBlue = blue(color);
+        if (ms == 1000) {
+            halfwayRed = red(color);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(100, frames);
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(255, 0, 0), pixels.shownColor[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, frameIntervalUs());
+    // Gamma keeps the halfway frame well under half of the linear output
+    TEST_ASSERT_GREATER_THAN(30, halfwayRed);
+    TEST_ASSERT_LESS_THAN(80, halfwayRed);
+}
+
+void test_other_block_changes_switch_at_once() {
+    RgbLed::indicateStatus(SLEEP);
+    fake::runTasks();
+    RgbLed::indicateStatus(QUIET);
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(0, frameIntervalUs());
+    TEST_ASSERT_EQUAL_UINT32(2, pixels.showCount);
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(255, 255, 0), pixels.shownColor[0]);
+}
+
+void test_crossfade_ends_at_the_linear_brightness() {
+    RgbLed::setBrightness(128);
+    RgbLed::indicateStatus(QUIET);
+    fake::runTasks();
+    RgbLed::indicateStatus(WAKE);
+    play(2100);
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(0, 128, 0), pixels.shownColor[0]);
+}
+
+void test_new_block_during_a_fade_cuts_it_short() {
+    RgbLed::indicateStatus(WIND_DOWN);
+    fake::runTasks();
+    RgbLed::indicateStatus(SLEEP);
+    play(500);
+    RgbLed::indicateStatus(QUIET);
+    fake::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(0, frameIntervalUs());
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(255, 255, 0), pixels.shownColor[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, play(1000));
+}
+
+// 3 ms frames are 15% of a 20 ms interval: one halving brings them in budget
+void test_slow_frames_halve_the_frame_rate() {
+    pixels.showCostUs = 3000;
+    RgbLed::indicateStatus(WIND_DOWN);
+    fake::runTasks();
+    RgbLed::indicateStatus(SLEEP);
+    fake::runTasks();
+
+    uint32_t frames = play(100);
+    TEST_ASSERT_EQUAL_UINT32(40000, frameIntervalUs());
+    frames += play(2000);
+    TEST_ASSERT_LESS_OR_EQUAL(55, frames);
+    TEST_ASSERT_GREATER_OR_EQUAL(45, frames);
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(255, 0, 0), pixels.shownColor[0]);
+}
+
+// Past the slowest frame rate the fade gives up and shows where it was going
+void test_frames_too_slow_for_any_rate_end_the_fade() {
+    pixels.showCostUs = 20000;
+    RgbLed::indicateStatus(QUIET);
+    fake::runTasks();
+    RgbLed::indicateStatus(WAKE);
+    fake::runTasks();
+
+    uint32_t frames = play(600);
+    TEST_ASSERT_EQUAL_UINT32(0, frameIntervalUs());
+    TEST_ASSERT_LESS_OR_EQUAL(6, frames);
+    TEST_ASSERT_EQUAL_HEX32(Adafruit_NeoPixel::Color(0, 255, 0), pixels.shownColor[0]);
+}
+
+// Benchmark: host cost of a crossfade frame, stepped by the frame timer
+void test_benchmark_crossfade_frame_cost() {
+    const uint32_t CYCLES = 200;
+    uint32_t fadeFrames = 0;
+    std::chrono::duration<double, std::nano> busy(0);
+
+    for (uint32_t cycle = 0; cycle < CYCLES; cycle++) {
+        const ScheduleBlock blocks[] = {WIND_DOWN, SLEEP, QUIET, WAKE};
+        for (ScheduleBlock block : blocks) {
+            RgbLed::indicateStatus(block);
+            fake::runTasks();
+            bool fading = block == SLEEP || block == WAKE;
+            for (uint32_t frame = 0; fading && frame < 105; frame++) {
+                fake::advanceMs(20);
+                uint32_t before = pixels.showCount;
+                auto start = std::chrono::steady_clock::now();
+                fake::runTasks();
+                busy += std::chrono::steady_clock::now() - start;
+                fadeFrames += pixels.showCount - before;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(CYCLES * 2 * 100, fadeFrames);
+
+    char message[120];
+    snprintf(message, sizeof(message), "%lu crossfade frames: %.0f ns per frame, %lu frames per fade",
+             (unsigned long)fadeFrames, busy.count() / fadeFrames, (unsigned long)(fadeFrames / CYCLES / 2));
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_go_out_from_the_led_task);
+    RUN_TEST(test_unchanged_frames_are_skipped);
+    RUN_TEST(test_frames_posted_while_the_task_is_busy_collapse_to_the_latest);
+    RUN_TEST(test_brightness_change_redraws_the_same_colour);
+    RUN_TEST(test_benchmark_frame_cost);
+    RUN_TEST(test_sleep_crossfade_steps_on_the_frame_timer);
+    RUN_TEST(test_other_block_changes_switch_at_once);
+    RUN_TEST(test_crossfade_ends_at_the_linear_brightness);
+    RUN_TEST(test_new_block_during_a_fade_cuts_it_short);
+    RUN_TEST(test_slow_frames_halve_the_frame_rate);
+    RUN_TEST(test_frames_too_slow_for_any_rate_end_the_fade);
+    RUN_TEST(test_benchmark_crossfade_frame_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <Wire.h>
+#include <chrono>
+#include "display.h"
+#include "settings.h"
+#include "state_machine.h"
+
+// HT16K33: acknowledges everything, nothing to read back
+class FakeHt16k33 : public fake::I2cDevice {
+public:
+    bool write(const uint8_t*, size_t) override { return true; }
+    bool read(uint8_t* data, size_t length) override {
+        memset(data, 0, length);
+        return true;
+    }
+};
+
+static const uint8_t DISPLAY_ADDRESS = 0x70;
+
+static FakeHt16k33 display;
+
+static const StateId MENU_RING[] = {
+    StateId::MenuTime, StateId::MenuSchedule, StateId::MenuNap,
+    StateId::MenuBrightness, StateId::MenuLock, StateId::MenuBack,
+};
+static const uint8_t MENU_RING_SIZE = sizeof(MENU_RING) / sizeof(MENU_RING[0]);
+
+// By name, so a failure says which states were involved
+#define assertState(expected) \
+    TEST_ASSERT_EQUAL_STRING(StateMachine::getStateName(expected), StateMachine::getStateName(StateMachine::getState()))
+
+static void step(Action action) {
+    StateMachine::post(action);
+    StateMachine::dispatch();
+}
+
+void setUp() {
+    fake::reset();
+    Wire.reset();
+    Wire.attach(DISPLAY_ADDRESS, &display);
+    TEST_ASSERT_TRUE(Settings::init());
+    Display::init();
+    StateMachine::setState(StateId::MenuTime);
+}
+
+void tearDown() {}
+
+void test_menu_ring_wraps_both_ways() {
+    for (uint8_t i = 1; i <= MENU_RING_SIZE; i++) {
+        step(CW);
+        assertState(MENU_RING[i % MENU_RING_SIZE]);
+    }
+    step(CCW);
+    assertState(StateId::MenuBack);
+    step(CW);
+    assertState(StateId::MenuTime);
+}
+
+void test_select_enters_a_menu_entry_and_back_leaves_the_menu() {
+    step(SELECT);
+    assertState(StateId::TimeSetHours);
+
+    StateMachine::setState(StateId::MenuBack);
+    step(SELECT);
+    assertState(StateId::Clock);
+}
+
+void test_actions_without_a_handler_leave_the_state_alone() {
+    step(TIME_CHANGE);
+    step(SELECT_HOLD);
+    assertState(StateId::MenuTime);
+}
+
+void test_events_are_handled_in_order_and_the_queue_is_bounded() {
+    for (int i = 0; i < 3; i++) {
+        StateMachine::post(CW);
+    }
+    StateMachine::post(CCW);
+    StateMachine::dispatch();
+    assertState(StateId::MenuNap);
+
+    // Eight fit; the rest are dropped
+    for (int i = 0; i < 12; i++) {
+        StateMachine::post(CW);
+    }
+    StateMachine::dispatch();
+    assertState(MENU_RING[(2 + 8) % MENU_RING_SIZE]);
+}
+
+void test_state_names_cover_every_state() {
+    for (uint8_t id = 0; id < static_cast<uint8_t>(StateId::Count); id++) {
+        TEST_ASSERT_TRUE(strcmp("?", StateMachine::getStateName(static_cast<StateId>(id))) != 0);
+    }
+    TEST_ASSERT_EQUAL_STRING("?", StateMachine::getStateName(StateId::Count));
+}
+
+// Benchmark: transitions per second around the menu ring with the real
+// states, one display flush per loop pass as in the firmware, against
+// dispatching actions that have no handler
+void test_benchmark_transitions_per_second() {
+    const uint32_t TRANSITIONS = 600000;
+    uint32_t busBytes = Wire.bytes;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < TRANSITIONS; i++) {
+        step(CW);
+        Display::flush();
+    }
+    std::chrono::duration<double> transitionTime = std::chrono::steady_clock::now() - start;
+    assertState(StateId::MenuTime);
+    busBytes = Wire.bytes - busBytes;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < TRANSITIONS; i++) {
+        step(TIME_CHANGE);
+    }
+    std::chrono::duration<double> unhandledTime = std::chrono::steady_clock::now() - start;
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%lu transitions: %.0f per second (%.0f ns each), %.1f display bus bytes each; "
+             "unhandled dispatch %.0f ns",
+             (unsigned long)TRANSITIONS, TRANSITIONS / transitionTime.count(),
+             transitionTime.count() * 1e9 / TRANSITIONS, (double)busBytes / TRANSITIONS,
+             unhandledTime.count() * 1e9 / TRANSITIONS);
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_menu_ring_wraps_both_ways);
+    RUN_TEST(test_select_enters_a_menu_entry_and_back_leaves_the_menu);
+    RUN_TEST(test_actions_without_a_handler_leave_the_state_alone);
+    RUN_TEST(test_events_are_handled_in_order_and_the_queue_is_bounded);
+    RUN_TEST(test_state_names_cover_every_state);
+    RUN_TEST(test_benchmark_transitions_per_second);
+    return UNITY_END();
+}
@@ -0,0 +1,236 @@
+#include <unity.h>
+#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
+#include <vector>
+#include "clock.h"
+#include "rgbled.h"
+#include "settings.h"
+#include "timeline.h"
+
+extern Adafruit_NeoPixel pixels;
+
+static const uint16_t MINUTES_PER_DAY = Timeline::MINUTES_PER_DAY;
+static const uint16_t MINUTES_PER_WEEK = Timeline::MINUTES_PER_WEEK;
+
+// Weeknights on the default schedule, a later weekend, and Sunday with no
+// schedule at all, so Saturday night's sleep is cut off at midnight
+static void makeWeek(Schedule week[7]) {
+    for (int day = 0; day < 7; day++) {
+        week[day] = Schedule();
+    }
+    week[SUNDAY] = Schedule::fromBoundaries({0, 0, 0, 0, 0});
+    for (DayOfWeek day : {FRIDAY, SATURDAY}) {
+        week[day] = Schedule::fromBoundaries({20 * 60 + 45, 21 * 60, 8 * 60, 8 * 60 + 30, 9 * 60});
+    }
+}
+
+// The block at a minute, straight from the definition
+static ScheduleBlock referenceBlock(const Schedule week[7], const Schedule* nap, uint16_t minuteOfWeek) {
+    uint16_t minuteOfDay = minuteOfWeek % MINUTES_PER_DAY;
+    if (nap != nullptr && nap->getBlockAt(minuteOfDay) != NO_BLOCK) {
+        return nap->getBlockAt(minuteOfDay);
+    }
+    return week[minuteOfWeek / MINUTES_PER_DAY].getBlockAt(minuteOfDay);
+}
+
+// Minutes of week at which the reference block changes
+static std::vector<uint16_t> referenceTransitions(const Schedule week[7]) {
+    std::vector<uint16_t> transitions;
+    for (uint16_t minute = 0; minute < MINUTES_PER_WEEK; minute++) {
+        uint16_t previous = (minute + MINUTES_PER_WEEK - 1) % MINUTES_PER_WEEK;
+        if (referenceBlock(week, nullptr, minute) != referenceBlock(week, nullptr, previous)) {
+            transitions.push_back(minute);
+        }
+    }
+    return transitions;
+}
+
+void setUp() {
+    fake::reset();
+    Wire.reset();
+}
+
+void tearDown() {}
+
+void test_compute_finds_the_next_change_from_every_minute() {
+    Schedule week[7];
+    makeWeek(week);
+
+    for (uint16_t minute = 0; minute < MINUTES_PER_WEEK; minute++) {
+        uint16_t transition;
+        ScheduleBlock nextBlock;
+        ScheduleBlock block = Timeline::compute(week, nullptr, minute, transition, nextBlock);
+        TEST_ASSERT_EQUAL(referenceBlock(week, nullptr, minute), block);
+
+        uint16_t expected = (minute + 1) % MINUTES_PER_WEEK;
+        while (referenceBlock(week, nullptr, expected) == block) {
+            expected = (expected + 1) % MINUTES_PER_WEEK;
+        }
+        TEST_ASSERT_EQUAL_UINT16(expected, transition);
+        TEST_ASSERT_EQUAL(referenceBlock(week, nullptr, expected), nextBlock);
+    }
+}
+
+// Recompute only when the countdown runs out, as onMinute() does, and check
+// every change in the week fires exactly once and on time
+void test_week_walk_fires_each_transition_once() {
+    Schedule week[7];
+    makeWeek(week);
+    std::vector<uint16_t> expected = referenceTransitions(week);
+    // Five boundaries on each scheduled day, and Sunday's empty day starting
+    // and ending at midnight
+    TEST_ASSERT_EQUAL(6 * 5 + 2, expected.size());
+
+    uint16_t transition;
+    ScheduleBlock nextBlock;
+    ScheduleBlock block = Timeline::compute(week, nullptr, 0, transition, nextBlock);
+    std::vector<uint16_t> fired;
+    for (uint32_t step = 1; step <= MINUTES_PER_WEEK; step++) {
+        uint16_t minute = step % MINUTES_PER_WEEK;
+        if (minute == transition) {
+            TEST_ASSERT_EQUAL(nextBlock, referenceBlock(week, nullptr, minute));
+            block = Timeline::compute(week, nullptr, minute, transition, nextBlock);
+            fired.push_back(minute);
+        }
+        TEST_ASSERT_EQUAL(referenceBlock(week, nullptr, minute), block);
+    }
+
+    std::sort(fired.begin(), fired.end());
+    TEST_ASSERT_EQUAL(expected.size(), fired.size());
+    TEST_ASSERT_TRUE(expected == fired);
+}
+
+void test_compute_reports_no_transition_for_an_unchanging_week() {
+    Schedule week[7];
+    for (int day = 0; day < 7; day++) {
+        week[day] = Schedule::fromBoundaries({0, 0, 0, 0, 0});
+    }
+    uint16_t transition;
+    ScheduleBlock nextBlock;
+    TEST_ASSERT_EQUAL(NO_BLOCK, Timeline::compute(week, nullptr, 1234, transition, nextBlock));
+    TEST_ASSERT_EQUAL_UINT16(1234, transition);
+    TEST_ASSERT_EQUAL(NO_BLOCK, nextBlock);
+}
+
+void test_nap_overrides_the_day_until_it_ends() {
+    Schedule week[7];
+    makeWeek(week);
+    // Tuesday 13:00-14:00 nap, inside a day with nothing scheduled
+    Schedule nap = Schedule::fromBoundaries({12 * 60 + 45, 13 * 60, 14 * 60, 14 * 60 + 15, 14 * 60 + 30});
+    uint16_t start = TUESDAY * MINUTES_PER_DAY + 12 * 60;
+
+    uint16_t transition;
+    ScheduleBlock nextBlock;
+    ScheduleBlock block = Timeline::compute(week, &nap, start, transition, nextBlock);
+    TEST_ASSERT_EQUAL(NO_BLOCK, block);
+    TEST_ASSERT_EQUAL_UINT16(start + 45, transition);
+    TEST_ASSERT_EQUAL(WIND_DOWN, nextBlock);
+
+    std::vector<ScheduleBlock> seen;
+    for (uint16_t minute = start; minute < start + 3 * 60; minute++) {
+        if (minute == transition) {
+            block = Timeline::compute(week, &nap, minute, transition, nextBlock);
+            seen.push_back(block);
+        }
+        TEST_ASSERT_EQUAL(referenceBlock(week, &nap, minute), block);
+    }
+    std::vector<ScheduleBlock> expected = {WIND_DOWN, SLEEP, QUIET, WAKE, NO_BLOCK};
+    TEST_ASSERT_TRUE(expected == seen);
+}
+
+// DS3231 register file; Clock reads seven registers from address 0
+class FakeRtc : public fake::I2cDevice {
+public:
+    uint8_t registers[7] = {};
+    uint8_t pointer = 0;
+
+    bool write(const uint8_t* data, size_t length) override {
+        pointer = length > 0 ? data[0] : pointer;
+        return true;
+    }
+
+    bool read(uint8_t* data, size_t length) override {
+        for (size_t i = 0; i < length; i++) {
+            data[i] = registers[(pointer + i) % sizeof(registers)];
+        }
+        return true;
+    }
+};
+
+static uint8_t litChannels(uint32_t color) {
+    return ((color >> 16 & 0xFF) ? 4 : 0) | ((color >> 8 & 0xFF) ? 2 : 0) | ((color & 0xFF) ? 1 : 0);
+}
+
+static uint8_t blockChannels(ScheduleBlock block) {
+    switch (block) {
+        case WIND_DOWN: return 1; // Blue
+        case SLEEP: return 4;     // Red
+        case QUIET: return 6;     // Yellow
+        case WAKE: return 2;      // Green
+        default: return 0;
+    }
+}
+
+// A week of SQW ticks through Clock, Timeline and RgbLed: the block is right
+// every minute and the LED settles on a new colour once per transition
+void test_week_of_ticks_updates_the_led_once_per_transition() {
+    Schedule week[7];
+    makeWeek(week);
+    TEST_ASSERT_TRUE(Settings::init());
+    TEST_ASSERT_TRUE(Settings::saveAllSchedules(week));
+    TEST_ASSERT_TRUE(Settings::setNapEnabled(false));
+
+    FakeRtc rtc;
+    const uint8_t sundayMidnight[] = {0x00, 0x00, 0x00, 0x07, 0x04, 0x01, 0x26}; // RTC Sunday is 7
+    memcpy(rtc.registers, sundayMidnight, sizeof(rtc.registers));
+    Wire.attach(0x68, &rtc);
+    const int sqwPin = 1;
+    Clock::init(sqwPin);
+    Clock::enableSQWInterrupt();
+    Clock::setResyncInterval(0xFFFFFFFF);
+    RgbLed::init();
+    Timeline::rebuild();
+    fake::runTasks();
+
+    uint32_t showsBefore = pixels.showCount;
+    uint8_t lit = litChannels(pixels.shownColor[0]);
+    uint32_t colourChanges = 0;
+    for (uint32_t step = 1; step <= MINUTES_PER_WEEK; step++) {
+        for (int second = 0; second < 60; second++) {
+            fake::pinInterrupt[sqwPin]();
+            Clock::update();
+        }
+        // Play any crossfade frame by frame, then let the rest of the minute pass
+        fake::runTasks();
+        for (int frame = 0; frame < 150; frame++) {
+            fake::advanceMs(20);
+            fake::runTasks();
+        }
+        fake::advanceMs(60000 - 150 * 20);
+        fake::runTasks();
+
+        uint16_t minute = step % MINUTES_PER_WEEK;
+        ScheduleBlock expected = referenceBlock(week, nullptr, minute);
+        TEST_ASSERT_EQUAL(expected, Timeline::getCurrentBlock());
+        TEST_ASSERT_EQUAL_UINT8(blockChannels(expected), litChannels(pixels.shownColor[0]));
+        if (litChannels(pixels.shownColor[0]) != lit) {
+            lit = litChannels(pixels.shownColor[0]);
+            colourChanges++;
+        }
+    }
+
+    uint32_t transitions = referenceTransitions(week).size();
+    TEST_ASSERT_EQUAL_UINT32(transitions, colourChanges);
+    // The sleep and wake crossfades take many frames, everything else one
+    TEST_ASSERT_GREATER_OR_EQUAL(transitions + 12 * 50, pixels.showCount - showsBefore);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_compute_finds_the_next_change_from_every_minute);
+    RUN_TEST(test_week_walk_fires_each_transition_once);
+    RUN_TEST(test_compute_reports_no_transition_for_an_unchanging_week);
+    RUN_TEST(test_nap_overrides_the_day_until_it_ends);
+    RUN_TEST(test_week_of_ticks_updates_the_led_once_per_transition);
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""Decode the clock's binary log stream back to text.
+
+With Log::setBinaryMode(true) the firmware sends each log call as a small
+frame holding a format ID, the timestamp and the raw arguments. Format
+strings are sent once, the first time each ID is used, so start the decoder
+before the clock boots (or re-enable binary mode to resend them). Anything
+that is not a valid frame is passed through as plain text.
+
+Frame layout (see src/logging.cpp):
+    0xA5, kind, length, payload[length], checksum
+    checksum = (kind + length + sum(payload)) & 0xFF
+    kind 1, definition: id, format bytes
+    kind 2, message:    id, level (bit 7 = truncated), timestamp u32 LE, args
+
+Usage:
+    tools/log_decode.py /dev/ttyACM0 [--baud 115200]   (needs pyserial)
+    tools/log_decode.py capture.bin
+    tools/log_decode.py - < capture.bin
+"""
+
+import argparse
+import os
+import re
+import stat
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+KIND_DEFINITION = 1
+KIND_MESSAGE = 2
+FRAME_TRUNCATED = 0x80
+LEVELS = ["ERROR", "WARN", "NOTICE", "INFO", "DEBUG"]
+
+# Mirrors encodeArgs() in src/logging.cpp
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+)?)?(hh|h|ll|l|j|z|t|L)?([diuxXocfFeEgGaAsp%])")
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise EOFError
+        (value,) = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += size
+        return value
+
+    def string(self):
+        length = self.take("<B")
+        if self.pos + length > len(self.data):
+            raise EOFError
+        text = self.data[self.pos:self.pos + length].decode("utf-8", "replace")
+        self.pos += length
+        return text
+
+
+def format_message(fmt, args, truncated):
+    reader = Reader(args)
+    out = []
+    last = 0
+    for match in SPEC.finditer(fmt):
+        out.append(fmt[last:match.start()])
+        last = match.end()
+        flags, width, precision, length, conv = match.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            values = []
+            if width == "*":
+                values.append(reader.take("<i"))
+            if precision == "*":
+                values.append(reader.take("<i"))
+            wide = length in ("ll", "j")
+            if conv in "di":
+                values.append(reader.take("<q" if wide else "<i"))
+            elif conv in "uxXoc":
+                values.append(reader.take("<Q" if wide else "<I"))
+            elif conv in "fFeEgGaA":
+                values.append(reader.take("<f"))
+                if conv in "aA":
+                    conv = "e" if conv == "a" else "E"
+            elif conv == "s":
+                values.append(reader.string())
+            elif conv == "p":
+                values.append(reader.take("<I"))
+                conv, flags = "x", flags + "#"
+        except EOFError:
+            out.append("<?>")
+            continue
+        spec = "%" + flags + (width or "")
+        if precision is not None:
+            spec += "." + precision
+        out.append((spec + conv) % tuple(values))
+    out.append(fmt[last:])
+    text = "".join(out)
+    return text + " <truncated>" if truncated else text
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.formats = {}
+        self.buffer = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        while self.buffer:
+            if self.buffer[0] != FRAME_SYNC:
+                self.passthrough(self.buffer.pop(0))
+                continue
+            if len(self.buffer) < 3:
+                return
+            kind, length = self.buffer[1], self.buffer[2]
+            if kind not in (KIND_DEFINITION, KIND_MESSAGE):
+                self.passthrough(self.buffer.pop(0))
+                continue
+            if len(self.buffer) < 3 + length + 1:
+                return
+            payload = bytes(self.buffer[3:3 + length])
+            checksum = (kind + length + sum(payload)) & 0xFF
+            if checksum != self.buffer[3 + length]:
+                # Not a frame after all; resync on the next byte
+                self.passthrough(self.buffer.pop(0))
+                continue
+            del self.buffer[:3 + length + 1]
+            self.frame(kind, payload)
+
+    def passthrough(self, byte):
+        if byte == ord("\n"):
+            self.out.write(self.text.decode("utf-8", "replace") + "\n")
+            self.text.clear()
+        elif byte != ord("\r"):
+            self.text.append(byte)
+
+    def frame(self, kind, payload):
+        if not payload:
+            return
+        format_id = payload[0]
+        if kind == KIND_DEFINITION:
+            self.formats[format_id] = payload[1:].decode("utf-8", "replace")
+            return
+        if len(payload) < 6:
+            return
+        level = payload[1] & ~FRAME_TRUNCATED
+        truncated = bool(payload[1] & FRAME_TRUNCATED)
+        (timestamp,) = struct.unpack_from("<I", payload, 2)
+        args = payload[6:]
+        fmt = self.formats.get(format_id)
+        if fmt is None:
+            text = "<unknown format %d: %s>" % (format_id, args.hex())
+        else:
+            text = format_message(fmt, args, truncated)
+        name = LEVELS[level] if level < len(LEVELS) else str(level)
+        self.out.write("[%08d] [%s] %s\n" % (timestamp, name, text))
+        self.out.flush()
+
+
+def open_source(path, baud):
+    if path == "-":
+        return sys.stdin.buffer
+    mode = os.stat(path).st_mode
+    if stat.S_ISCHR(mode):
+        import serial  # pyserial
+        return serial.Serial(path, baud, timeout=0.1)
+    return open(path, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("source", help="serial port, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    options = parser.parse_args()
+
+    decoder = Decoder(sys.stdout)
+    source = open_source(options.source, options.baud)
+    is_serial = hasattr(source, "in_waiting")
+    try:
+        while True:
+            data = source.read(256 if is_serial else 4096)
+            if not data:
+                if is_serial:
+                    continue
+                break
+            decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()